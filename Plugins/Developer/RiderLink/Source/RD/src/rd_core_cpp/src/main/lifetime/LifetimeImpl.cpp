@@ -1,5 +1,6 @@
 #include "LifetimeImpl.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace rd
@@ -8,6 +9,31 @@ namespace rd
 LifetimeImpl::counter_t LifetimeImpl::get_id = 0;
 #endif
 
+constexpr LifetimeImpl::counter_t LifetimeImpl::INLINE_ACTIONS;
+
+bool LifetimeImpl::action_t::empty() const
+{
+	return !callback && !nested;
+}
+
+void LifetimeImpl::action_t::clear()
+{
+	callback = nullptr;
+	nested.reset();
+}
+
+void LifetimeImpl::action_t::run() const
+{
+	if (nested)
+	{
+		nested->terminate();
+	}
+	else if (callback)
+	{
+		callback();
+	}
+}
+
 LifetimeImpl::LifetimeImpl(bool is_eternal) : eternaled(is_eternal), id(LifetimeImpl::get_id++)
 {
 }
@@ -17,22 +43,89 @@ void LifetimeImpl::terminate()
 	if (is_eternal())
 		return;
 
-	terminated = true;
+	if (terminated.exchange(true))
+		return;
 
 	// region thread-safety section
 
-	actions_t actions_copy;
+	std::array<action_t, INLINE_ACTIONS> inline_copy;
+	std::vector<action_t> more_copy;
+	LifetimeImpl* parent_copy = nullptr;
 	{
 		std::lock_guard<decltype(actions_lock)> guard(actions_lock);
-		actions_copy = std::move(actions);
+		inline_copy = std::move(inline_actions);
+		more_copy = std::move(more_actions);
+		more_actions.clear();
+		removed_actions = 0;
 
-		actions.clear();
+		std::swap(parent_copy, parent);
 	}
 	// endregion
 
-	for (auto it = actions_copy.rbegin(); it != actions_copy.rend(); ++it)
+	for (auto it = more_copy.rbegin(); it != more_copy.rend(); ++it)
+	{
+		it->run();
+	}
+	for (auto it = inline_copy.rbegin(); it != inline_copy.rend(); ++it)
+	{
+		it->run();
+	}
+
+	if (parent_copy != nullptr && !parent_copy->is_terminated())
+	{
+		parent_copy->remove_action(id_in_parent);
+	}
+}
+
+LifetimeImpl::action_t& LifetimeImpl::new_action()
+{
+	const counter_t id = action_id_in_map++;
+	if (id < INLINE_ACTIONS)
 	{
-		it->second();
+		inline_actions[id].id = id;
+		return inline_actions[id];
+	}
+	more_actions.emplace_back();
+	more_actions.back().id = id;
+	return more_actions.back();
+}
+
+LifetimeImpl::action_t* LifetimeImpl::find_action(counter_t i)
+{
+	if (i < 0)
+	{
+		return nullptr;
+	}
+	if (i < INLINE_ACTIONS)
+	{
+		return &inline_actions[i];
+	}
+	// ids only grow, the vector stays sorted by them
+	const auto it = std::lower_bound(
+		more_actions.begin(), more_actions.end(), i, [](action_t const& a, counter_t id) { return a.id < id; });
+	return it != more_actions.end() && it->id == i ? &*it : nullptr;
+}
+
+void LifetimeImpl::remove_action(counter_t i)
+{
+	// actions were already taken by terminate
+	if (is_terminated())
+		return;
+
+	std::lock_guard<decltype(actions_lock)> guard(actions_lock);
+
+	action_t* action = find_action(i);
+	if (action == nullptr || action->empty())
+	{
+		return;
+	}
+	action->clear();
+
+	if (i >= INLINE_ACTIONS && ++removed_actions * 2 > more_actions.size())
+	{
+		more_actions.erase(std::remove_if(more_actions.begin(), more_actions.end(), [](action_t const& a) { return a.empty(); }),
+			more_actions.end());
+		removed_actions = 0;
 	}
 }
 
@@ -51,9 +144,22 @@ void LifetimeImpl::attach_nested(std::shared_ptr<LifetimeImpl> nested)
 	if (nested->is_terminated() || is_eternal())
 		return;
 
-	std::function<void()> action = [nested] { nested->terminate(); };
-	counter_t action_id = add_action(action);
-	nested->add_action([this, id = action_id] { actions.erase(id); });
+	counter_t action_id;
+	{
+		std::lock_guard<decltype(actions_lock)> guard(actions_lock);
+		if (is_terminated())
+		{
+			throw std::invalid_argument("Already Terminated");
+		}
+		action_t& action = new_action();
+		action.nested = nested;
+		action_id = action.id;
+	}
+	{
+		std::lock_guard<decltype(nested->actions_lock)> guard(nested->actions_lock);
+		nested->parent = this;
+		nested->id_in_parent = action_id;
+	}
 }
 
 LifetimeImpl::~LifetimeImpl()
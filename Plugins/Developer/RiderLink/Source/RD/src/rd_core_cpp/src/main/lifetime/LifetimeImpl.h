@@ -8,12 +8,14 @@
 
 #include <std/hash.h>
 
+#include <array>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <atomic>
 #include <utility>
+#include <vector>
 
 #include <thirdparty.hpp>
 
@@ -36,12 +38,43 @@ private:
 
 	counter_t id = 0;
 
+	/**
+	 * \brief Termination action, either a callback or a nested lifetime to terminate.
+	 * Removed actions are left empty in place until the lifetime terminates or they are compacted.
+	 */
+	struct action_t
+	{
+		counter_t id = -1;
+		std::function<void()> callback;
+		std::shared_ptr<LifetimeImpl> nested;
+
+		bool empty() const;
+
+		void clear();
+
+		void run() const;
+	};
+
+	// most lifetimes have only a couple of actions, they don't need the vector
+	static constexpr counter_t INLINE_ACTIONS = 2;
+
 	counter_t action_id_in_map = 0;
-	using actions_t = ordered_map<int, std::function<void()>, rd::hash<int>>;
-	actions_t actions;
+	std::array<action_t, INLINE_ACTIONS> inline_actions;
+	std::vector<action_t> more_actions;
+	size_t removed_actions = 0;
+
+	// set for nested lifetimes, which remove their action from the parent when terminated first
+	LifetimeImpl* parent = nullptr;
+	counter_t id_in_parent = -1;
 
 	void terminate();
 
+	// must be called under actions_lock
+	action_t& new_action();
+
+	// must be called under actions_lock
+	action_t* find_action(counter_t i);
+
 	std::mutex actions_lock;
 
 public:
@@ -67,16 +100,12 @@ public:
 			throw std::invalid_argument("Already Terminated");
 		}
 
-		actions[action_id_in_map] = std::forward<F>(action);
-		return action_id_in_map++;
+		action_t& slot = new_action();
+		slot.callback = std::forward<F>(action);
+		return slot.id;
 	}
 
-	void remove_action(counter_t i)
-	{
-		std::lock_guard<decltype(actions_lock)> guard(actions_lock);
-
-		actions.erase(i);
-	}
+	void remove_action(counter_t i);
 
 #if __cplusplus >= 201703L
 	static inline counter_t get_id = 0;
@@ -7,9 +7,11 @@
 #include <lifetime/Lifetime.h>
 #include <util/core_util.h>
 
+#include <algorithm>
 #include <utility>
 #include <functional>
 #include <atomic>
+#include <vector>
 
 namespace rd
 {
@@ -38,6 +40,8 @@ private:
 		}
 
 		Event(Event&&) = default;
+
+		Event& operator=(Event&&) = default;
 		// endregion
 
 		bool is_alive() const
@@ -45,44 +49,140 @@ private:
 			return !lifetime->is_terminated();
 		}
 
-		void execute_if_alive(T const& value) const
+		bool execute_if_alive(T const& value) const
 		{
 			if (is_alive())
 			{
 				action(value);
+				return true;
 			}
+			return false;
 		}
 	};
 
-	using counter_t = int32_t;
-	using listeners_t = std::map<counter_t, Event>;
+	/**
+	 * \brief Listeners in advise order. The first one is stored inline, the others in a vector.
+	 * Listeners advised while firing are added once the outermost fire returns, and terminated ones are
+	 * compacted away only when they make up at least half of the listeners.
+	 */
+	class Listeners
+	{
+	private:
+		optional<Event> head;
+		std::vector<Event> tail;
+		std::vector<Event> added_while_firing;
+		int32_t firing = 0;
+		size_t dead_seen = 0;
 
-	mutable counter_t advise_id = 0;
-	mutable listeners_t listeners, priority_listeners;
+		size_t size() const
+		{
+			return (head ? 1 : 0) + tail.size();
+		}
 
-	static void cleanup(listeners_t& queue)
-	{
-		util::erase_if(queue, [](Event const& e) -> bool { return !e.is_alive(); });
-	}
+		void compact()
+		{
+			tail.erase(std::remove_if(tail.begin(), tail.end(), [](Event const& e) -> bool { return !e.is_alive(); }), tail.end());
+			if (head && !head->is_alive())
+			{
+				head.reset();
+			}
+			if (!head && !tail.empty())
+			{
+				head.emplace(std::move(tail.front()));
+				tail.erase(tail.begin());
+			}
+		}
 
-	void fire_impl(T const& value, listeners_t& queue) const
-	{
-		for (auto const& p : queue)
+		void add(Event&& event)
 		{
-			auto const& event = p.second;
-			event.execute_if_alive(value);
+			if (!head)
+			{
+				head.emplace(std::move(event));
+			}
+			else
+			{
+				tail.emplace_back(std::move(event));
+			}
 		}
-		cleanup(queue);
-	}
+
+		// listeners and the vector are left untouched while any fire is running
+		class firing_guard
+		{
+			Listeners& that;
+
+		public:
+			explicit firing_guard(Listeners& that) : that(that)
+			{
+				++that.firing;
+			}
+
+			~firing_guard()
+			{
+				if (--that.firing == 0)
+				{
+					that.after_fire();
+				}
+			}
+		};
+
+		void after_fire()
+		{
+			if (dead_seen > 0 && dead_seen * 2 >= size())
+			{
+				compact();
+			}
+			dead_seen = 0;
+			for (auto& event : added_while_firing)
+			{
+				add(std::move(event));
+			}
+			added_while_firing.clear();
+		}
+
+		void execute(Event const& event, T const& value)
+		{
+			if (!event.execute_if_alive(value))
+			{
+				++dead_seen;
+			}
+		}
+
+	public:
+		void advise(Event&& event)
+		{
+			if (firing > 0)
+			{
+				added_while_firing.emplace_back(std::move(event));
+			}
+			else
+			{
+				add(std::move(event));
+			}
+		}
+
+		void fire(T const& value)
+		{
+			if (!head)
+			{
+				return;
+			}
+			firing_guard guard(*this);
+			execute(*head, value);
+			for (size_t i = 0; i < tail.size(); ++i)
+			{
+				execute(tail[i], value);
+			}
+		}
+	};
+
+	mutable Listeners listeners, priority_listeners;
 
 	template <typename F>
-	void advise0(const Lifetime& lifetime, F&& handler, listeners_t& queue) const
+	void advise0(const Lifetime& lifetime, F&& handler, Listeners& queue) const
 	{
 		if (lifetime->is_terminated())
 			return;
-		counter_t id = advise_id /*.load()*/;
-		queue.emplace(id, Event(std::forward<F>(handler), lifetime));
-		++advise_id;
+		queue.advise(Event(std::forward<F>(handler), lifetime));
 	}
 
 public:
@@ -106,8 +206,8 @@ public:
 
 	void fire(T const& value) const override
 	{
-		fire_impl(value, priority_listeners);
-		fire_impl(value, listeners);
+		priority_listeners.fire(value);
+		listeners.fire(value);
 	}
 
 	using ISignal<T>::advise;
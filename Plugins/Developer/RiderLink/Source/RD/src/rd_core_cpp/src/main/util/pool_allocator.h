@@ -0,0 +1,117 @@
+#ifndef RD_CPP_POOL_ALLOCATOR_H
+#define RD_CPP_POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Allocator which keeps freed single objects in an intrusive free list and hands them out again.
+ * Meant for small objects created and destroyed in large numbers, e.g. with std::allocate_shared.
+ * Arrays and over-aligned types go straight to operator new.
+ */
+template <typename T>
+class pool_allocator
+{
+	struct node
+	{
+		node* next;
+	};
+
+	static constexpr size_t BLOCK_SIZE = sizeof(T) < sizeof(node) ? sizeof(node) : sizeof(T);
+	static constexpr size_t MAX_FREE_BLOCKS = 4096;
+
+	struct pool
+	{
+		std::mutex lock;
+		node* head = nullptr;
+		size_t size = 0;
+
+		~pool()
+		{
+			while (head != nullptr)
+			{
+				node* next = head->next;
+				::operator delete(head);
+				head = next;
+			}
+		}
+	};
+
+	static pool& get_pool()
+	{
+		static pool instance;
+		return instance;
+	}
+
+	static constexpr bool poolable(size_t n)
+	{
+		return n == 1 && alignof(T) <= alignof(std::max_align_t);
+	}
+
+public:
+	using value_type = T;
+
+	pool_allocator() noexcept = default;
+
+	template <typename U>
+	pool_allocator(pool_allocator<U> const&) noexcept
+	{
+	}
+
+	T* allocate(size_t n)
+	{
+		if (poolable(n))
+		{
+			pool& p = get_pool();
+			std::lock_guard<std::mutex> guard(p.lock);
+			if (p.head != nullptr)
+			{
+				node* block = p.head;
+				p.head = block->next;
+				--p.size;
+				return reinterpret_cast<T*>(block);
+			}
+			return static_cast<T*>(::operator new(BLOCK_SIZE));
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t n) noexcept
+	{
+		if (poolable(n))
+		{
+			pool& p = get_pool();
+			std::lock_guard<std::mutex> guard(p.lock);
+			if (p.size < MAX_FREE_BLOCKS)
+			{
+				node* block = reinterpret_cast<node*>(ptr);
+				block->next = p.head;
+				p.head = block;
+				++p.size;
+				return;
+			}
+		}
+		::operator delete(ptr);
+	}
+
+	template <typename U>
+	friend bool operator==(pool_allocator const&, pool_allocator<U> const&) noexcept
+	{
+		return true;
+	}
+
+	template <typename U>
+	friend bool operator!=(pool_allocator const&, pool_allocator<U> const&) noexcept
+	{
+		return false;
+	}
+};
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_POOL_ALLOCATOR_H
@@ -21,6 +21,12 @@ public:
 	 * Otherwise, local changes can be performed only on the UI thread.
 	 */
 	bool async = false;
+
+	/**
+	 * \brief If set to false, messages of this object may be handled concurrently and in any order when its wire
+	 * scheduler has [IScheduler::out_of_order_execution]. Otherwise they're handled one at a time in the order they came.
+	 */
+	bool ordered = true;
 	// region ctor/dtor
 
 	IRdReactive() = default;
@@ -6,4 +6,27 @@ void WireBase::advise(Lifetime lifetime, const IRdReactive* entity) const
 {
 	message_broker.advise_on(lifetime, entity);
 }
+
+WireStatistics& WireBase::enable_statistics()
+{
+	std::lock_guard<decltype(statistics_lock)> guard(statistics_lock);
+	if (statistics == nullptr)
+	{
+		statistics = std::make_unique<WireStatistics>([this](RdId id) { return message_broker.location_of(id); });
+	}
+	message_broker.set_statistics(statistics.get());
+	return *statistics;
+}
+
+void WireBase::disable_statistics()
+{
+	std::lock_guard<decltype(statistics_lock)> guard(statistics_lock);
+	message_broker.set_statistics(nullptr);
+}
+
+WireStatistics const* WireBase::get_statistics() const
+{
+	std::lock_guard<decltype(statistics_lock)> guard(statistics_lock);
+	return statistics.get();
+}
 }	 // namespace rd
@@ -4,6 +4,10 @@
 #include "reactive/Property.h"
 #include "base/IWire.h"
 #include "protocol/MessageBroker.h"
+#include "wire/WireStatistics.h"
+
+#include <memory>
+#include <mutex>
 
 #include <rd_framework_export.h>
 
@@ -16,6 +20,14 @@ protected:
 
 	MessageBroker message_broker;
 
+private:
+	mutable std::mutex statistics_lock;
+
+	/**
+	 * \brief Created by the first [enable_statistics] and kept while the wire lives, messages in flight refer to it.
+	 */
+	std::unique_ptr<WireStatistics> statistics;
+
 public:
 	// region ctor/dtor
 	explicit WireBase(IScheduler* scheduler) : scheduler(scheduler), message_broker(scheduler)
@@ -26,6 +38,19 @@ public:
 	// endregion
 
 	void advise(Lifetime lifetime, IRdReactive const* entity) const override;
+
+	/**
+	 * \brief Starts collecting [WireStatistics] of the messages this wire sends and dispatches, after
+	 * [disable_statistics] the counts go on from where they stopped. Statistics are off by default and cost nothing then.
+	 */
+	WireStatistics& enable_statistics();
+
+	void disable_statistics();
+
+	/**
+	 * \brief Statistics collected so far, null if they have never been enabled.
+	 */
+	WireStatistics const* get_statistics() const;
 };
 }	 // namespace rd
 
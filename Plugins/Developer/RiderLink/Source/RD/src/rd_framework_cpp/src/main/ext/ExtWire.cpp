@@ -21,7 +21,11 @@ ExtWire::ExtWire()
 					auto it = std::move(sendQ.front());
 					sendQ.pop();
 					realWire->send(
-						it.first, [payload = std::move(it.second)](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+						it.first, [payload = std::move(it.second)](Buffer& buffer) {
+							// queued before the real wire was known, in the default encoding
+							buffer.set_encoding(Buffer::Encoding::Fixed);
+							buffer.write_byte_array_raw(payload);
+						});
 				}
 			}
 		}
@@ -70,7 +70,7 @@ void RdExtBase::on_wire_received(Buffer buffer) const
 		}
 	}
 
-	int64_t counterpartSerializationHash = buffer.read_integral<int64_t>();
+	int64_t counterpartSerializationHash = buffer.read_fixed_integral<int64_t>();
 	if (serializationHash != counterpartSerializationHash)
 	{
 		RD_ASSERT_MSG(false, "serializationHash of ext " + to_string(location) +
@@ -84,7 +84,7 @@ void RdExtBase::sendState(IWire const& wire, ExtState state) const
 {
 	wire.send(rdid, [&](Buffer& buffer) {
 		buffer.write_enum<ExtState>(state);
-		buffer.write_integral<int64_t>(serializationHash);
+		buffer.write_fixed_integral<int64_t>(serializationHash);
 	});
 }
 
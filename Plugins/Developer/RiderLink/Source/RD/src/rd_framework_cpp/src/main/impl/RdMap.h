@@ -226,6 +226,7 @@ public:
 			{
 				auto writer =
 					util::make_shared_function([version, serialized_key = std::move(serialized_key)](Buffer& innerBuffer) mutable {
+						innerBuffer.set_encoding(serialized_key.get_encoding());	// key is copied as is
 						innerBuffer.write_integral<int32_t>((1u << versionedFlagShift) | static_cast<int32_t>(Op::ACK));
 						innerBuffer.write_integral<int64_t>(version);
 						// KS::write(this->get_serialization_context(), innerBuffer, wrapper::get<K>(key));
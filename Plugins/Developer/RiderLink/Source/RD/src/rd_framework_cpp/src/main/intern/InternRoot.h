@@ -3,14 +3,12 @@
 
 #include "base/RdReactiveBase.h"
 #include "InternScheduler.h"
+#include "InternTable.h"
 #include "lifetime/Lifetime.h"
 #include "types/wrapper.h"
 #include "serialization/RdAny.h"
 #include "util/core_traits.h"
 
-#include "tsl/ordered_map.h"
-
-#include <vector>
 #include <string>
 #include <mutex>
 
@@ -36,13 +34,8 @@ class Identities;
 class RD_FRAMEWORK_API InternRoot final : public RdReactiveBase
 {
 private:
-	// template<typename T>
-	mutable std::vector<InternedAny> my_items_lis;
-
-	// template<typename T>
-	mutable ordered_map<int32_t, InternedAny> other_items_list;
-	// template<typename T>
-	mutable ordered_map<InternedAny, int32_t, any::TransparentHash, any::TransparentKeyEqual> inverse_map;
+	// read without a lock, written under [lock]
+	mutable InternTable items;
 
 	mutable InternScheduler intern_scheduler;
 
@@ -78,15 +71,6 @@ public:
 
 namespace rd
 {
-/*template<typename T>
-std::vector<value_or_wrapper<T>> InternRoot::myItemsList = {};
-
-template<typename T>
-ordered_map<int32_t, value_or_wrapper<T>> InternRoot::otherItemsList = {};
-
-template<typename T>
-ordered_map<value_or_wrapper<T>, int32_t> InternRoot::inverseMap = {};*/
-
 constexpr bool InternRoot::is_index_owned(int32_t id)
 {
 	return !static_cast<bool>(id & 1);
@@ -96,7 +80,9 @@ template <typename T>
 Wrapper<T> InternRoot::un_intern_value(int32_t id) const
 {
 	// don't need lock because value's already exists and never removes
-	return any::get<T>(is_index_owned(id) ? my_items_lis[id / 2] : other_items_list[id / 2]);
+	InternedAny const* value = items.get(id);
+	RD_ASSERT_THROW_MSG(value != nullptr, "Value with intern id " + std::to_string(id) + " wasn't interned")
+	return any::get<T>(*value);
 }
 
 template <typename T>
@@ -104,30 +90,24 @@ int32_t InternRoot::intern_value(Wrapper<T> value) const
 {
 	InternedAny any = any::make_interned_any<T>(value);
 
+	int32_t index = items.find(any);
+	if (index != InternTable::NOT_INTERNED)
+	{
+		return index;
+	}
+
 	std::lock_guard<decltype(lock)> guard(lock);
 
-	auto it = inverse_map.find(any);
-	int32_t index = 0;
-	if (it == inverse_map.end())
+	// could have been interned while waiting for the lock
+	index = items.find(any);
+	if (index == InternTable::NOT_INTERNED)
 	{
 		get_protocol()->get_wire()->send(this->rdid, [this, &index, value, any](Buffer& buffer) {
 			InternedAnySerializer::write<T>(get_serialization_context(), buffer, wrapper::get<T>(value));
-			{
-				std::lock_guard<decltype(lock)> guard(lock);
-				index = static_cast<int32_t>(my_items_lis.size()) * 2;
-				my_items_lis.emplace_back(any);
-			}
+			index = items.add_own(any);
 			buffer.write_integral<int32_t>(index);
 		});
 	}
-	else
-	{
-		index = it->second;
-	}
-	if (inverse_map.count(any) == 0)
-	{
-		inverse_map[any] = index;
-	}
 	return index;
 }
 }	 // namespace rd
@@ -0,0 +1,237 @@
+#include "InternTable.h"
+
+namespace rd
+{
+constexpr int32_t InternTable::Items::FIRST_CHUNK_BITS;
+constexpr int32_t InternTable::Items::MAX_CHUNKS;
+constexpr size_t InternTable::Index::INITIAL_CAPACITY;
+constexpr int32_t InternTable::NOT_INTERNED;
+
+// region Items
+
+void InternTable::Items::locate(int32_t index, int32_t& chunk, int32_t& offset)
+{
+	const uint32_t v = (static_cast<uint32_t>(index) >> FIRST_CHUNK_BITS) + 1;
+	chunk = 0;
+	while ((v >> (chunk + 1)) != 0)
+	{
+		++chunk;
+	}
+	offset = index - static_cast<int32_t>(((1u << chunk) - 1) << FIRST_CHUNK_BITS);
+}
+
+InternTable::Items::~Items()
+{
+	clear();
+}
+
+InternedAny const* InternTable::Items::get(int32_t index) const
+{
+	if (index < 0)
+	{
+		return nullptr;
+	}
+	int32_t chunk, offset;
+	locate(index, chunk, offset);
+	slot const* slots = chunks[chunk].load(std::memory_order_acquire);
+	if (slots == nullptr || !slots[offset].ready.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+	return &slots[offset].value;
+}
+
+void InternTable::Items::set(int32_t index, InternedAny value)
+{
+	RD_ASSERT_THROW_MSG(index >= 0, "Negative intern index: " + std::to_string(index))
+
+	int32_t chunk, offset;
+	locate(index, chunk, offset);
+	slot* slots = chunks[chunk].load(std::memory_order_relaxed);
+	if (slots == nullptr)
+	{
+		slots = new slot[static_cast<size_t>(1) << (FIRST_CHUNK_BITS + chunk)];
+		chunks[chunk].store(slots, std::memory_order_release);
+	}
+	// published values are read without a lock, so they are never replaced
+	if (slots[offset].ready.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	slots[offset].value = std::move(value);
+	slots[offset].ready.store(true, std::memory_order_release);
+}
+
+void InternTable::Items::clear()
+{
+	for (auto& chunk : chunks)
+	{
+		delete[] chunk.exchange(nullptr);
+	}
+}
+
+// endregion
+
+// region Index
+
+InternTable::Index::table::table(size_t capacity) : mask(capacity - 1), buckets(new std::atomic<node const*>[capacity])
+{
+	for (size_t i = 0; i < capacity; ++i)
+	{
+		buckets[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+void InternTable::Index::link(table& t, InternedAny const& value, int32_t id, size_t hash)
+{
+	auto& bucket = t.buckets[hash & t.mask];
+	t.nodes.push_back(node{value, id, hash, bucket.load(std::memory_order_relaxed)});
+	bucket.store(&t.nodes.back(), std::memory_order_release);
+}
+
+size_t InternTable::Index::enter_reading() const
+{
+	while (true)
+	{
+		const uint64_t current_epoch = epoch.load();
+		const size_t slot = static_cast<size_t>(current_epoch & 1u);
+		readers[slot].fetch_add(1);
+		if (epoch.load() == current_epoch)
+		{
+			return slot;
+		}
+		// a table has been retired meanwhile, its writer may have missed this reader
+		readers[slot].fetch_sub(1);
+	}
+}
+
+void InternTable::Index::leave_reading(size_t slot) const
+{
+	readers[slot].fetch_sub(1);
+}
+
+void InternTable::Index::reclaim()
+{
+	if (!draining.empty())
+	{
+		if (readers[static_cast<size_t>((epoch.load() - 1) & 1u)].load() != 0)
+		{
+			return;
+		}
+		draining.clear();
+	}
+	if (retired.empty())
+	{
+		return;
+	}
+	draining = std::move(retired);
+	retired.clear();
+	// readers entering from now on see the live table, only those of the previous epoch may walk the retired ones
+	const size_t slot = static_cast<size_t>(epoch.fetch_add(1) & 1u);
+	if (readers[slot].load() == 0)
+	{
+		draining.clear();
+	}
+}
+
+int32_t InternTable::Index::find(InternedAny const& value) const
+{
+	const size_t hash = any::TransparentHash()(value);
+	int32_t id = NOT_INTERNED;
+
+	const size_t slot = enter_reading();
+	table const* t = current.load();
+	if (t != nullptr)
+	{
+		for (node const* n = t->buckets[hash & t->mask].load(std::memory_order_acquire); n != nullptr; n = n->next)
+		{
+			if (n->hash == hash && any::TransparentKeyEqual()(n->value, value))
+			{
+				id = n->id;
+				break;
+			}
+		}
+	}
+	leave_reading(slot);
+	return id;
+}
+
+void InternTable::Index::insert(InternedAny const& value, int32_t id)
+{
+	reclaim();
+
+	table* t = live.get();
+	if (t == nullptr || t->nodes.size() > t->mask)
+	{
+		// rebuild in insertion order so later values still shadow earlier ones
+		auto grown = std::make_unique<table>(t == nullptr ? INITIAL_CAPACITY : (t->mask + 1) * 2);
+		if (t != nullptr)
+		{
+			for (auto const& n : t->nodes)
+			{
+				link(*grown, n.value, n.id, n.hash);
+			}
+		}
+		t = grown.get();
+		current.store(t);
+		if (live != nullptr)
+		{
+			retired.push_back(std::move(live));
+		}
+		live = std::move(grown);
+		reclaim();
+	}
+	link(*t, value, id, any::TransparentHash()(value));
+}
+
+void InternTable::Index::clear()
+{
+	current.store(nullptr);
+	live.reset();
+	retired.clear();
+	draining.clear();
+}
+
+size_t InternTable::Index::tables_alive() const
+{
+	return (live != nullptr ? 1 : 0) + retired.size() + draining.size();
+}
+
+// endregion
+
+InternedAny const* InternTable::get(int32_t id) const
+{
+	return items[id & 1].get(id / 2);
+}
+
+int32_t InternTable::find(InternedAny const& value) const
+{
+	return index.find(value);
+}
+
+int32_t InternTable::add_own(InternedAny const& value)
+{
+	const int32_t id = own_count++ * 2;
+	set(id, value);
+	return id;
+}
+
+void InternTable::set(int32_t id, InternedAny const& value)
+{
+	items[id & 1].set(id / 2, value);
+	index.insert(value, id);
+}
+
+void InternTable::clear()
+{
+	items[0].clear();
+	items[1].clear();
+	index.clear();
+	own_count = 0;
+}
+
+size_t InternTable::index_tables_alive() const
+{
+	return index.tables_alive();
+}
+}	 // namespace rd
@@ -0,0 +1,166 @@
+#ifndef RD_CPP_INTERNTABLE_H
+#define RD_CPP_INTERNTABLE_H
+
+#include "serialization/RdAny.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+namespace rd
+{
+/**
+ * \brief Interned values of both sides of a connection.
+ * Values are never removed until [clear], so lookups in either direction don't lock:
+ * ids map to slots in append-only chunks which are never moved, values map to ids through a hash index
+ * whose buckets are swapped atomically when it grows and freed once no reader can still walk them.
+ * Writes ([set], [clear]) must be serialized by the owner.
+ */
+class RD_FRAMEWORK_API InternTable
+{
+private:
+	/**
+	 * \brief Slots addressed by index, chunk k holds FIRST_CHUNK_SIZE << k of them.
+	 */
+	class Items
+	{
+	private:
+		struct slot
+		{
+			std::atomic<bool> ready{false};
+			InternedAny value;
+		};
+
+		static constexpr int32_t FIRST_CHUNK_BITS = 6;
+		static constexpr int32_t MAX_CHUNKS = 32 - FIRST_CHUNK_BITS;
+
+		std::array<std::atomic<slot*>, MAX_CHUNKS> chunks{};
+
+		static void locate(int32_t index, int32_t& chunk, int32_t& offset);
+
+	public:
+		// region ctor/dtor
+
+		Items() = default;
+
+		Items(Items const&) = delete;
+
+		~Items();
+		// endregion
+
+		InternedAny const* get(int32_t index) const;
+
+		void set(int32_t index, InternedAny value);
+
+		void clear();
+	};
+
+	/**
+	 * \brief Value to id index. Nodes are immutable once published, the bucket table is rebuilt when it fills up.
+	 * A lookup registers as a reader in the slot of the current epoch while it walks a table. The table replaced by
+	 * a rebuild is retired, the next write advances the epoch and frees it as soon as the readers of the previous
+	 * epoch have left; writers never wait for readers.
+	 */
+	class Index
+	{
+	private:
+		struct node
+		{
+			InternedAny value;
+			int32_t id;
+			size_t hash;
+			node const* next;
+		};
+
+		struct table
+		{
+			explicit table(size_t capacity);
+
+			size_t mask;
+			std::unique_ptr<std::atomic<node const*>[]> buckets;
+			std::deque<node> nodes;
+		};
+
+		static constexpr size_t INITIAL_CAPACITY = 64;
+
+		std::atomic<table*> current{nullptr};
+		std::unique_ptr<table> live;
+		// replaced in the current epoch
+		std::vector<std::unique_ptr<table>> retired;
+		// replaced before the last epoch change, freed once readers[previous slot] drops to zero
+		std::vector<std::unique_ptr<table>> draining;
+
+		mutable std::atomic<uint64_t> epoch{0};
+		mutable std::array<std::atomic<int32_t>, 2> readers{};
+
+		size_t enter_reading() const;
+
+		void leave_reading(size_t slot) const;
+
+		void reclaim();
+
+		static void link(table& t, InternedAny const& value, int32_t id, size_t hash);
+
+	public:
+		int32_t find(InternedAny const& value) const;
+
+		void insert(InternedAny const& value, int32_t id);
+
+		void clear();
+
+		size_t tables_alive() const;
+	};
+
+	// own ids are even, counterpart's ids are odd
+	Items items[2];
+	Index index;
+	int32_t own_count = 0;
+
+public:
+	static constexpr int32_t NOT_INTERNED = -1;
+
+	/**
+	 * \return value interned with [id] or nullptr if there is none yet.
+	 */
+	InternedAny const* get(int32_t id) const;
+
+	/**
+	 * \return id of [value] or NOT_INTERNED.
+	 */
+	int32_t find(InternedAny const& value) const;
+
+	/**
+	 * \brief Interns [value] with the next own id, writers only.
+	 */
+	int32_t add_own(InternedAny const& value);
+
+	/**
+	 * \brief Interns [value] with [id] chosen by either side, writers only.
+	 */
+	void set(int32_t id, InternedAny const& value);
+
+	/**
+	 * \brief Forgets everything, there must be no concurrent readers.
+	 */
+	void clear();
+
+	/**
+	 * \return number of value index tables still allocated, the current one included. Writers only, for diagnostics.
+	 */
+	size_t index_tables_alive() const;
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_INTERNTABLE_H
@@ -4,6 +4,12 @@
 
 #include <string>
 #include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RD_UTF16_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace rd
 {
@@ -70,6 +76,16 @@ void Buffer::rewind()
 	set_position(0);
 }
 
+Buffer::Encoding Buffer::get_encoding() const
+{
+	return encoding;
+}
+
+void Buffer::set_encoding(Encoding value)
+{
+	encoding = value;
+}
+
 Buffer::ByteArray Buffer::getArray() const&
 {
 	return data_;
@@ -131,11 +147,185 @@ std::vector<uint8_t> v(value.begin(), value.end());
 writeArray<uint8_t>(v);
 }*/
 
+// region utf-16
+
+// The wire carries UTF-16 code units, where wchar_t is UTF-32 they are converted eight at a time while no
+// surrogate is in sight. Surrogate pairs are joined and split, unpaired surrogates pass through unchanged
+// so that any string of the counterpart survives a round trip, characters beyond U+10FFFF become U+FFFD.
+namespace
+{
+constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+inline uint16_t load_unit(Buffer::word_t const* src, size_t i)
+{
+	uint16_t unit;
+	std::memcpy(&unit, src + sizeof(uint16_t) * i, sizeof(uint16_t));
+	return unit;
+}
+
+inline void store_unit(Buffer::word_t* dst, size_t i, uint32_t unit)
+{
+	const auto value = static_cast<uint16_t>(unit);
+	std::memcpy(dst + sizeof(uint16_t) * i, &value, sizeof(uint16_t));
+}
+
+/**
+ * \brief Decodes the character starting at unit [i] of [units] into [dst], returns the number of units consumed.
+ */
+inline size_t decode_utf16(Buffer::word_t const* src, size_t i, size_t units, wchar_t& dst)
+{
+	const uint32_t unit = load_unit(src, i);
+	if (unit >= 0xD800 && unit < 0xDC00 && i + 1 < units)
+	{
+		const uint32_t low = load_unit(src, i + 1);
+		if (low >= 0xDC00 && low < 0xE000)
+		{
+			dst = static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+			return 2;
+		}
+	}
+	dst = static_cast<wchar_t>(unit);
+	return 1;
+}
+
+inline size_t utf16_length(uint32_t c)
+{
+	return c > 0xFFFF && c <= 0x10FFFF ? 2 : 1;
+}
+
+/**
+ * \brief Converts [units] UTF-16 code units at [src] to [dst], returns the number of characters written.
+ */
+inline size_t utf16_to_wide(Buffer::word_t const* src, size_t units, wchar_t* dst)
+{
+	size_t i = 0, len = 0;
+#ifdef RD_UTF16_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i surrogate_mask = _mm_set1_epi16(static_cast<int16_t>(0xF800));
+	const __m128i surrogate = _mm_set1_epi16(static_cast<int16_t>(0xD800));
+	while (i + 8 <= units)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + sizeof(uint16_t) * i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(x, surrogate_mask), surrogate)) == 0)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + len), _mm_unpacklo_epi16(x, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + len + 4), _mm_unpackhi_epi16(x, zero));
+			i += 8;
+			len += 8;
+			continue;
+		}
+		for (const size_t end = i + 8; i < end; ++len)
+		{
+			i += decode_utf16(src, i, units, dst[len]);
+		}
+	}
+#endif
+	while (i < units)
+	{
+		i += decode_utf16(src, i, units, dst[len++]);
+	}
+	return len;
+}
+
+/**
+ * \brief Returns the number of UTF-16 code units [wide_to_utf16] writes for [len] characters at [src].
+ */
+inline size_t utf16_units(wchar_t const* src, size_t len)
+{
+	size_t i = 0, units = len;
+#ifdef RD_UTF16_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	while (i + 8 <= len)
+	{
+		const __m128i lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		const __m128i hi = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i + 4));
+		const __m128i upper = _mm_or_si128(_mm_srli_epi32(lo, 16), _mm_srli_epi32(hi, 16));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(upper, zero)) != 0xFFFF)
+		{
+			for (size_t k = i; k < i + 8; ++k)
+			{
+				units += utf16_length(static_cast<uint32_t>(src[k])) - 1;
+			}
+		}
+		i += 8;
+	}
+#endif
+	for (; i < len; ++i)
+	{
+		units += utf16_length(static_cast<uint32_t>(src[i])) - 1;
+	}
+	return units;
+}
+
+inline size_t encode_utf16(uint32_t c, Buffer::word_t* dst, size_t units)
+{
+	if (c <= 0xFFFF)
+	{
+		store_unit(dst, units, c);
+		return 1;
+	}
+	if (c > 0x10FFFF)
+	{
+		store_unit(dst, units, REPLACEMENT_CHARACTER);
+		return 1;
+	}
+	store_unit(dst, units, 0xD800 + ((c - 0x10000) >> 10));
+	store_unit(dst, units + 1, 0xDC00 + ((c - 0x10000) & 0x3FF));
+	return 2;
+}
+
+/**
+ * \brief Converts [len] characters at [src] to UTF-16 code units at [dst].
+ */
+inline void wide_to_utf16(wchar_t const* src, size_t len, Buffer::word_t* dst)
+{
+	size_t i = 0, units = 0;
+#ifdef RD_UTF16_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	while (i + 8 <= len)
+	{
+		const __m128i lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		const __m128i hi = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i + 4));
+		const __m128i upper = _mm_or_si128(_mm_srli_epi32(lo, 16), _mm_srli_epi32(hi, 16));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(upper, zero)) == 0xFFFF)
+		{
+			// sign-extend the low halves so that the saturating pack keeps them as they are
+			const __m128i packed = _mm_packs_epi32(
+				_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + sizeof(uint16_t) * units), packed);
+			units += 8;
+		}
+		else
+		{
+			for (size_t k = i; k < i + 8; ++k)
+			{
+				units += encode_utf16(static_cast<uint32_t>(src[k]), dst, units);
+			}
+		}
+		i += 8;
+	}
+#endif
+	for (; i < len; ++i)
+	{
+		units += encode_utf16(static_cast<uint32_t>(src[i]), dst, units);
+	}
+}
+}	 // namespace
+
+// endregion
+
 template <int>
 std::wstring read_wstring_spec(Buffer& buffer)
 {
-	auto v = buffer.read_array<std::vector, uint16_t>();
-	return std::wstring(v.begin(), v.end());
+	const int32_t units = buffer.read_integral<int32_t>();
+	RD_ASSERT_MSG(units >= 0, "read null string(length =" + std::to_string(units) + ")");
+	const size_t bytes = sizeof(uint16_t) * units;
+	buffer.check_available(bytes);
+	std::wstring result;
+	result.resize(units);
+	result.resize(utf16_to_wide(buffer.current_pointer(), units, &result[0]));
+	buffer.offset += bytes;
+	return result;
 }
 
 template <>
@@ -157,8 +347,12 @@ std::wstring Buffer::read_wstring()
 template <int>
 void write_wstring_spec(Buffer& buffer, wstring_view value)
 {
-	const std::vector<uint16_t> v(value.begin(), value.end());
-	buffer.write_array<std::vector, uint16_t>(v);
+	const size_t units = utf16_units(value.data(), value.size());
+	buffer.write_integral<int32_t>(static_cast<int32_t>(units));
+	const size_t bytes = sizeof(uint16_t) * units;
+	buffer.require_available(bytes);
+	wide_to_utf16(value.data(), value.size(), buffer.current_pointer());
+	buffer.offset += bytes;
 }
 
 template <>
@@ -204,7 +398,7 @@ int64_t TICKS_PER_MILLISECOND = 10000000;
 
 DateTime Buffer::read_date_time()
 {
-	int64_t time_in_ticks = read_integral<int64_t>();
+	int64_t time_in_ticks = read_fixed_integral<int64_t>();
 	time_t t = static_cast<time_t>((time_in_ticks - TICKS_AT_EPOCH) / TICKS_PER_MILLISECOND);
 	return DateTime{t};
 }
@@ -212,7 +406,7 @@ DateTime Buffer::read_date_time()
 void Buffer::write_date_time(DateTime const& date_time)
 {
 	uint64_t t = date_time.seconds * TICKS_PER_MILLISECOND + TICKS_AT_EPOCH;
-	write_integral<int64_t>(t);
+	write_fixed_integral<int64_t>(t);
 }
 
 bool Buffer::read_bool()
@@ -16,6 +16,8 @@
 #include <type_traits>
 #include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 #include <rd_framework_export.h>
 
@@ -35,6 +37,16 @@ public:
 
 	using ByteArray = std::vector<word_t, Allocator>;
 
+	/**
+	 * \brief How [read_integral] and [write_integral] lay out integers wider than a byte.
+	 * [Fixed] is little-endian of the type's width, [Compact] is a (zig-zag for signed types) varint.
+	 */
+	enum class Encoding : uint8_t
+	{
+		Fixed,
+		Compact
+	};
+
 private:
 	template <int>
 	friend std::wstring read_wstring_spec(Buffer&);
@@ -46,6 +58,8 @@ private:
 
 	size_t offset = 0;
 
+	Encoding encoding = Encoding::Fixed;
+
 	// read
 	void read(word_t* dst, size_t size);
 
@@ -83,20 +97,115 @@ public:
 
 	void rewind();
 
+	Encoding get_encoding() const;
+
+	/**
+	 * \brief Switches the layout of integers, must be called before any of them is read or written.
+	 */
+	void set_encoding(Encoding value);
+
 	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value, T>>
 	T read_integral()
+	{
+		if (sizeof(T) > 1 && encoding == Encoding::Compact)
+		{
+			return read_varint<T>();
+		}
+		return read_fixed_integral<T>();
+	}
+
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
+	void write_integral(T const& value)
+	{
+		if (sizeof(T) > 1 && encoding == Encoding::Compact)
+		{
+			write_varint<T>(value);
+			return;
+		}
+		write_fixed_integral<T>(value);
+	}
+
+	/**
+	 * \brief Reads an integer written by [write_fixed_integral] regardless of the encoding.
+	 */
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value, T>>
+	T read_fixed_integral()
 	{
 		T result;
 		read(reinterpret_cast<word_t*>(&result), sizeof(T));
 		return result;
 	}
 
+	/**
+	 * \brief Writes an integer in its full width regardless of the encoding,
+	 * for hashes and for values patched in place afterwards.
+	 */
 	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
-	void write_integral(T const& value)
+	void write_fixed_integral(T const& value)
 	{
 		write(reinterpret_cast<word_t const*>(&value), sizeof(T));
 	}
 
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value, T>>
+	T read_varint()
+	{
+		using U = std::make_unsigned_t<T>;
+		constexpr size_t max_length = (sizeof(T) * 8 + 6) / 7;
+
+		const size_t available = size() - offset;
+		const word_t* p = current_pointer();
+		U value = 0;
+		for (size_t i = 0; i < max_length; ++i)
+		{
+			if (i == available)
+			{
+				check_available(i + 1);
+			}
+			const word_t b = p[i];
+			value |= static_cast<U>(b & 0x7F) << (7 * i);
+			if ((b & 0x80) == 0)
+			{
+				offset += i + 1;
+				return from_zigzag<T>(value);
+			}
+		}
+		throw std::out_of_range("Malformed varint at " + std::to_string(offset));
+	}
+
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value>>
+	void write_varint(T const& value)
+	{
+		constexpr size_t max_length = (sizeof(T) * 8 + 6) / 7;
+
+		require_available(max_length);
+		word_t* p = current_pointer();
+		auto rest = to_zigzag<T>(value);
+		size_t i = 0;
+		while (rest >= 0x80)
+		{
+			p[i++] = static_cast<word_t>(rest | 0x80);
+			rest >>= 7;
+		}
+		p[i++] = static_cast<word_t>(rest);
+		offset += i;
+	}
+
+	template <typename T>
+	static constexpr std::make_unsigned_t<T> to_zigzag(T value)
+	{
+		using U = std::make_unsigned_t<T>;
+		return std::is_signed<T>::value ? static_cast<U>((static_cast<U>(value) << 1) ^ static_cast<U>(value < 0 ? ~U{0} : U{0}))
+										: static_cast<U>(value);
+	}
+
+	template <typename T>
+	static constexpr T from_zigzag(std::make_unsigned_t<T> value)
+	{
+		using U = std::make_unsigned_t<T>;
+		return std::is_signed<T>::value ? static_cast<T>(static_cast<U>(value >> 1) ^ static_cast<U>(U{0} - (value & 1)))
+										: static_cast<T>(value);
+	}
+
 	template <typename T, typename = typename std::enable_if_t<std::is_floating_point<T>::value, T>>
 	T read_floating_point()
 	{
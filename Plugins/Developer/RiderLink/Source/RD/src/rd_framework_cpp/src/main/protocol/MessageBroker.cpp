@@ -2,56 +2,245 @@
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <thread>
+
 namespace rd
 {
 std::shared_ptr<spdlog::logger> MessageBroker::logger =
 	spdlog::stderr_color_mt<spdlog::synchronous_factory>("logger", spdlog::color_mode::automatic);
 
-static void execute(const IRdReactive* that, Buffer msg)
+constexpr size_t MessageBroker::INITIAL_SUBSCRIPTION_CAPACITY;
+
+static void execute(const IRdReactive* that, Buffer msg, WireStatistics::Receipt const& receipt)
 {
-	msg.read_integral<int16_t>();	   // skip context
-	that->on_wire_received(std::move(msg));
+	msg.read_fixed_integral<int16_t>();	   // skip context
+	WireStatistics::measure(receipt, [that, &msg] { that->on_wire_received(std::move(msg)); });
 }
 
-void MessageBroker::invoke(const IRdReactive* that, Buffer msg, bool sync) const
+void MessageBroker::invoke(const IRdReactive* that, Buffer msg, bool sync, WireStatistics::Receipt receipt) const
 {
 	if (sync)
 	{
-		execute(that, std::move(msg));
+		execute(that, std::move(msg), receipt);
 	}
 	else
 	{
-		auto action = [this, that, message = std::move(msg)]() mutable {
-			bool exists_id = false;
-			{
-				std::lock_guard<decltype(lock)> guard(lock);
-				exists_id = subscriptions.count(that->rdid) > 0;
-			}
-			if (exists_id)
-			{
-				execute(that, std::move(message));
-			}
-			else
-			{
-				logger->trace("Disappeared Handler for Reactive entities with id: {}", to_string(that->rdid));
-			}
-		};
-		std::function<void()> function = util::make_shared_function(std::move(action));
-		that->get_wire_scheduler()->queue(std::move(function));
+		queue_invoke(that, that->get_wire_scheduler(), that->ordered, that->rdid, std::move(msg), receipt);
 	}
 }
 
-MessageBroker::MessageBroker(IScheduler* defaultScheduler) : default_scheduler(defaultScheduler)
+void MessageBroker::queue_invoke(const IRdReactive* that, IScheduler* wire_scheduler, bool ordered, RdId id, Buffer msg,
+	WireStatistics::Receipt receipt) const
 {
+	auto action = [this, that, id, message = std::move(msg), receipt]() mutable {
+		if (find_subscription(id) == that)
+		{
+			execute(that, std::move(message), receipt);
+		}
+		else
+		{
+			logger->trace("Disappeared Handler for Reactive entities with id: {}", to_string(id));
+		}
+	};
+	std::function<void()> function = util::make_shared_function(std::move(action));
+	if (ordered)
+	{
+		// messages of one entity are handled in the order they came even by out of order schedulers
+		wire_scheduler->queue_ordered(hash<RdId>()(id), std::move(function));
+	}
+	else
+	{
+		wire_scheduler->queue(std::move(function));
+	}
+}
+
+size_t MessageBroker::enter_reading() const
+{
+	while (true)
+	{
+		const uint64_t current = epoch.load();
+		const size_t slot = static_cast<size_t>(current & 1u);
+		readers[slot].fetch_add(1);
+		if (epoch.load() == current)
+		{
+			return slot;
+		}
+		// a subscription has changed meanwhile, its writer may have missed this reader
+		readers[slot].fetch_sub(1);
+	}
+}
+
+void MessageBroker::leave_reading(size_t slot) const
+{
+	readers[slot].fetch_sub(1);
+}
+
+void MessageBroker::wait_for_readers() const
+{
+	// waits are serialized, so the readers of the epochs before the previous one have already left
+	std::lock_guard<decltype(grace_lock)> guard(grace_lock);
+	// readers entering from now on can't reach what has been unlinked, only those of the previous epoch may use it
+	const size_t slot = static_cast<size_t>(epoch.fetch_add(1) & 1u);
+	while (readers[slot].load() != 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void MessageBroker::release(retired_subscriptions retired) const
+{
+	if (retired.node != nullptr || retired.table != nullptr)
+	{
+		wait_for_readers();
+	}
+}
+
+MessageBroker::subscription_table::subscription_table(size_t capacity)
+	: mask(capacity - 1), buckets(new std::atomic<subscription_node*>[capacity])
+{
+	for (size_t i = 0; i < capacity; ++i)
+	{
+		buckets[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+MessageBroker::subscription_table::~subscription_table()
+{
+	for (size_t i = 0; i <= mask; ++i)
+	{
+		for (subscription_node* n = buckets[i].load(std::memory_order_relaxed); n != nullptr;)
+		{
+			subscription_node* next = n->next.load(std::memory_order_relaxed);
+			delete n;
+			n = next;
+		}
+	}
+}
+
+MessageBroker::MessageBroker(IScheduler* defaultScheduler)
+	: default_scheduler(defaultScheduler), live_subscriptions(new subscription_table(INITIAL_SUBSCRIPTION_CAPACITY))
+{
+	subscriptions.store(live_subscriptions.get());
+}
+
+IRdReactive const* MessageBroker::lookup_subscription(RdId id) const
+{
+	subscription_table const* t = subscriptions.load(std::memory_order_acquire);
+	for (subscription_node const* n = t->buckets[hash<RdId>()(id) & t->mask].load(std::memory_order_acquire); n != nullptr;
+		 n = n->next.load(std::memory_order_acquire))
+	{
+		if (n->id == id)
+		{
+			return n->entity;
+		}
+	}
+	return nullptr;
+}
+
+IRdReactive const* MessageBroker::find_subscription(RdId id) const
+{
+	const size_t slot = enter_reading();
+	IRdReactive const* entity = lookup_subscription(id);
+	leave_reading(slot);
+	return entity;
+}
+
+MessageBroker::retired_subscriptions MessageBroker::update_subscription(RdId id, IRdReactive const* entity) const
+{
+	retired_subscriptions retired;
+	subscription_table* t = live_subscriptions.get();
+	std::atomic<subscription_node*>* link = &t->buckets[hash<RdId>()(id) & t->mask];
+	subscription_node* n = link->load(std::memory_order_relaxed);
+	while (n != nullptr && n->id != id)
+	{
+		link = &n->next;
+		n = link->load(std::memory_order_relaxed);
+	}
+
+	if (n != nullptr)
+	{
+		if (n->entity == entity)
+		{
+			return retired;
+		}
+		// a reader standing on the unlinked node still finds the rest of the chain behind it
+		subscription_node* rest = n->next.load(std::memory_order_relaxed);
+		if (entity != nullptr)
+		{
+			link->store(new subscription_node{id, entity, {rest}}, std::memory_order_release);
+		}
+		else
+		{
+			link->store(rest, std::memory_order_release);
+			--t->size;
+		}
+		retired.node.reset(n);
+		return retired;
+	}
+	if (entity == nullptr)
+	{
+		return retired;
+	}
+
+	if (t->size > t->mask)
+	{
+		auto grown = std::make_unique<subscription_table>((t->mask + 1) * 2);
+		for (size_t i = 0; i <= t->mask; ++i)
+		{
+			for (subscription_node const* old = t->buckets[i].load(std::memory_order_relaxed); old != nullptr;
+				 old = old->next.load(std::memory_order_relaxed))
+			{
+				auto& bucket = grown->buckets[hash<RdId>()(old->id) & grown->mask];
+				bucket.store(new subscription_node{old->id, old->entity, {bucket.load(std::memory_order_relaxed)}},
+					std::memory_order_relaxed);
+			}
+		}
+		grown->size = t->size;
+		t = grown.get();
+		subscriptions.store(t, std::memory_order_release);
+		retired.table = std::move(live_subscriptions);
+		live_subscriptions = std::move(grown);
+	}
+	auto& bucket = t->buckets[hash<RdId>()(id) & t->mask];
+	bucket.store(new subscription_node{id, entity, {bucket.load(std::memory_order_relaxed)}}, std::memory_order_release);
+	++t->size;
+	return retired;
 }
 
 void MessageBroker::dispatch(RdId id, Buffer message) const
 {
 	RD_ASSERT_MSG(!id.isNull(), "id mustn't be null")
 
+	WireStatistics::Receipt receipt;
+	if (WireStatistics* current = get_statistics())
+	{
+		receipt = current->on_received(id, message.get_data().size());
+	}
+
+	IRdReactive const* s;
+	IScheduler* wire_scheduler = nullptr;
+	bool ordered = true;
+	{
+		// the entity isn't destroyed while it's read here, but may be once the handler is queued
+		const size_t slot = enter_reading();
+		s = lookup_subscription(id);
+		if (s != nullptr)
+		{
+			wire_scheduler = s->get_wire_scheduler();
+			ordered = s->ordered;
+		}
+		leave_reading(slot);
+	}
+	if (s != nullptr && (wire_scheduler == default_scheduler || wire_scheduler->out_of_order_execution))
+	{
+		// nothing to order against, no need for the lock
+		queue_invoke(s, wire_scheduler, ordered, id, std::move(message), receipt);
+		return;
+	}
+
 	{	 // synchronized recursively
 		std::lock_guard<decltype(lock)> guard(lock);
-		IRdReactive const* s = subscriptions[id];
+		s = find_subscription(id);
 		if (s == nullptr)
 		{
 			auto it = broker.find(id);
@@ -62,9 +251,10 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 
 			broker[id].default_scheduler_messages.emplace(std::move(message));
 
-			auto action = [this, it, id]() mutable {
+			// messages are queued and taken in the same order, this action handles the one received with [receipt]
+			auto action = [this, it, id, receipt]() mutable {
 				auto& current = it->second;
-				IRdReactive const* subscription = subscriptions[id];
+				IRdReactive const* subscription = find_subscription(id);
 
 				optional<Buffer> message;
 				{
@@ -79,7 +269,7 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 				{
 					if (message)
 					{
-						invoke(subscription, *std::move(message), subscription->get_wire_scheduler() == default_scheduler);
+						invoke(subscription, *std::move(message), subscription->get_wire_scheduler() == default_scheduler, receipt);
 					}
 				}
 				else
@@ -106,17 +296,18 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 		{
 			if (s->get_wire_scheduler() == default_scheduler || s->get_wire_scheduler()->out_of_order_execution)
 			{
-				invoke(s, std::move(message));
+				invoke(s, std::move(message), false, receipt);
 			}
 			else
 			{
 				auto it = broker.find(id);
 				if (it == broker.end())
 				{
-					invoke(s, std::move(message));
+					invoke(s, std::move(message), false, receipt);
 				}
 				else
 				{
+					// counted, but the latencies of messages held back for the default scheduler's queue aren't measured
 					Mq& mq = it->second;
 					mq.custom_scheduler_messages.push_back(std::move(message));
 				}
@@ -134,13 +325,37 @@ void MessageBroker::advise_on(Lifetime lifetime, IRdReactive const* entity) cons
 	// advise MUST happen under default scheduler, not custom
 	default_scheduler->assert_thread();
 
-	std::lock_guard<decltype(lock)> guard(lock);
-	if (!lifetime->is_terminated())
+	retired_subscriptions retired;
 	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (lifetime->is_terminated())
+		{
+			return;
+		}
 		auto key = entity->rdid;
-		IRdReactive const* value = entity;
-		subscriptions[key] = value;
-		lifetime->add_action([this, key]() { subscriptions.erase(key); });
+		retired = update_subscription(key, entity);
+		lifetime->add_action([this, key]() {
+			retired_subscriptions removed;
+			{
+				std::lock_guard<decltype(lock)> guard(lock);
+				removed = update_subscription(key, nullptr);
+			}
+			release(std::move(removed));
+		});
 	}
+	release(std::move(retired));
+}
+
+void MessageBroker::set_statistics(WireStatistics* value)
+{
+	statistics.store(value, std::memory_order_release);
+}
+
+std::string MessageBroker::location_of(RdId id) const
+{
+	// entities unsubscribe under the lock, the one found is alive until it's released
+	std::lock_guard<decltype(lock)> guard(lock);
+	IRdReactive const* entity = find_subscription(id);
+	return entity == nullptr ? std::string() : to_string(entity->location);
 }
 }	 // namespace rd
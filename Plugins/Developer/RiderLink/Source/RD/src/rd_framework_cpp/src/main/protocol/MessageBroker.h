@@ -7,11 +7,15 @@
 #endif
 
 #include "base/IRdReactive.h"
+#include "wire/WireStatistics.h"
 
 #include "std/unordered_map.h"
 
 #include "spdlog/spdlog.h"
 
+#include <array>
+#include <memory>
+#include <mutex>
 #include <queue>
 
 #include <rd_framework_export.h>
@@ -41,15 +45,103 @@ public:
 class RD_FRAMEWORK_API MessageBroker final
 {
 private:
+	/**
+	 * \brief Subscription of one id, immutable once it's linked into a table.
+	 */
+	struct subscription_node
+	{
+		RdId id;
+		IRdReactive const* entity;
+		std::atomic<subscription_node*> next;
+	};
+
+	struct subscription_table
+	{
+		explicit subscription_table(size_t capacity);
+
+		subscription_table(subscription_table const&) = delete;
+
+		// frees the nodes linked into it
+		~subscription_table();
+
+		size_t mask;
+		size_t size = 0;
+		std::unique_ptr<std::atomic<subscription_node*>[]> buckets;
+	};
+
+	/**
+	 * \brief What a change of the subscriptions has unlinked, freed by [release] once no reader can reach it.
+	 */
+	struct retired_subscriptions
+	{
+		std::unique_ptr<subscription_node> node;
+		std::unique_ptr<subscription_table> table;
+	};
+
+	static constexpr size_t INITIAL_SUBSCRIPTION_CAPACITY = 64;
+
 	IScheduler* default_scheduler = nullptr;
-	mutable rd::unordered_map<RdId, IRdReactive const*> subscriptions;
+
+	/**
+	 * \brief Subscriptions by id in a hash table which is read without the lock. A change under [lock] touches only
+	 * the node of its id: subscribing links a new node, replacing or removing unlinks the old one. The buckets are
+	 * rebuilt into a table twice as large when it fills up.
+	 */
+	mutable std::atomic<subscription_table const*> subscriptions{nullptr};
+	mutable std::unique_ptr<subscription_table> live_subscriptions;
 	mutable rd::unordered_map<RdId, Mq> broker;
 
 	mutable std::recursive_mutex lock;
 
+	/**
+	 * \brief Grace period for unlinked nodes and their entities: [find_subscription] and [dispatch] register as a
+	 * reader in the slot of the current epoch while they use them. [release] advances the epoch and waits until the
+	 * readers of the previous one have left, after [lock] is released; [grace_lock] serializes these waits.
+	 */
+	mutable std::atomic<uint64_t> epoch{0};
+	mutable std::array<std::atomic<int32_t>, 2> readers{};
+	mutable std::mutex grace_lock;
+
+	size_t enter_reading() const;
+
+	void leave_reading(size_t slot) const;
+
+	void wait_for_readers() const;
+
+	/**
+	 * \brief Frees [retired] once no reader uses it, returns at once if there's nothing to free. Mustn't be called
+	 * from a reading section.
+	 */
+	void release(retired_subscriptions retired) const;
+
+	/**
+	 * \brief Null unless statistics are enabled, then every dispatched message is counted and measured.
+	 */
+	std::atomic<WireStatistics*> statistics{nullptr};
+
 	static std::shared_ptr<spdlog::logger> logger;
 
-	void invoke(const IRdReactive* that, Buffer msg, bool sync = false) const;
+	void invoke(const IRdReactive* that, Buffer msg, bool sync = false, WireStatistics::Receipt receipt = {}) const;
+
+	/**
+	 * \brief Queues the handler of [that] on its [wire_scheduler] without touching [that], it's handled only if it's
+	 * still subscribed to [id] by then. Handlers of an [ordered] entity are queued in order of their [id].
+	 */
+	void queue_invoke(const IRdReactive* that, IScheduler* wire_scheduler, bool ordered, RdId id, Buffer msg,
+		WireStatistics::Receipt receipt) const;
+
+	/**
+	 * \brief Must be called in a reading section or under [lock].
+	 */
+	IRdReactive const* lookup_subscription(RdId id) const;
+
+	IRdReactive const* find_subscription(RdId id) const;
+
+	/**
+	 * \brief Must be called under [lock], removes the subscription if [entity] is null.
+	 * The node it unlinks has to be passed to [release] once the lock is released.
+	 */
+	retired_subscriptions update_subscription(RdId id, IRdReactive const* entity) const;
 
 public:
 	// region ctor/dtor
@@ -57,9 +149,26 @@ public:
 	explicit MessageBroker(IScheduler* defaultScheduler);
 	// endregion
 
+	/**
+	 * \brief Hands [message] to the entity subscribed to [id]. A handler queued on the entity's wire scheduler checks that
+	 * the entity is still subscribed when it runs there, so an entity must be unbound on that scheduler (or on the
+	 * default one if they're the same) and not destroyed while one of its handlers is running elsewhere.
+	 */
 	void dispatch(RdId id, Buffer message) const;
 
 	void advise_on(Lifetime lifetime, IRdReactive const* entity) const;
+
+	WireStatistics* get_statistics() const
+	{
+		return statistics.load(std::memory_order_acquire);
+	}
+
+	void set_statistics(WireStatistics* value);
+
+	/**
+	 * \brief Location of the entity subscribed to [id], empty if there is none.
+	 */
+	std::string location_of(RdId id) const;
 };
 }	 // namespace rd
 #if defined(_MSC_VER)
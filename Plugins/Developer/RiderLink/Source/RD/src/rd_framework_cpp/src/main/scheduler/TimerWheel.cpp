@@ -0,0 +1,304 @@
+#include "TimerWheel.h"
+
+#include "util/thread_util.h"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+namespace rd
+{
+constexpr size_t TimerWheel::SLOT_BITS;
+constexpr size_t TimerWheel::SLOTS;
+constexpr size_t TimerWheel::LEVELS;
+
+namespace
+{
+inline size_t first_occupied(uint64_t occupied, size_t from)
+{
+	// slot at or after [from], wrapping around
+	const uint64_t rotated = from == 0 ? occupied : (occupied >> from) | (occupied << (64 - from));
+	size_t distance = 0;
+	while (((rotated >> distance) & 1) == 0)
+	{
+		++distance;
+	}
+	return distance;
+}
+}	 // namespace
+
+TimerWheel::TimerWheel(std::string name, clock::duration tick) : name(std::move(name)), tick(tick)
+{
+	thread = std::thread([this] {
+		rd::util::set_thread_name(this->name.c_str());
+		run();
+	});
+}
+
+TimerWheel::~TimerWheel()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		stopping = true;
+	}
+	changed.notify_all();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+TimerWheel& TimerWheel::instance()
+{
+	static TimerWheel wheel("rd-timers");
+	return wheel;
+}
+
+uint64_t TimerWheel::now_tick() const
+{
+	return static_cast<uint64_t>((clock::now() - start) / tick);
+}
+
+TimerWheel::clock::time_point TimerWheel::time_of(uint64_t tick_number) const
+{
+	return start + tick * static_cast<clock::rep>(tick_number);
+}
+
+void TimerWheel::place(timer_id id, uint64_t deadline)
+{
+	// a timer is due in the slot it lands in at level 0, higher levels only hold it until it cascades down
+	deadline = (std::max)(deadline, current_tick + 1);
+	const uint64_t delta = deadline - current_tick;
+	size_t l = 0;
+	while (l + 1 < LEVELS && delta >= (uint64_t{1} << (SLOT_BITS * (l + 1))))
+	{
+		++l;
+	}
+	// beyond the top level the timer waits in its farthest slot and is placed again from there
+	const uint64_t target = l + 1 == LEVELS ? (std::min)(deadline, current_tick + (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1) : deadline;
+	const size_t slot = static_cast<size_t>((target >> (SLOT_BITS * l)) & (SLOTS - 1));
+	levels[l].slots[slot].push_back(id);
+	levels[l].occupied |= uint64_t{1} << slot;
+}
+
+void TimerWheel::cascade(size_t level_index)
+{
+	level& lv = levels[level_index];
+	const size_t slot = static_cast<size_t>((current_tick >> (SLOT_BITS * level_index)) & (SLOTS - 1));
+	if ((lv.occupied & (uint64_t{1} << slot)) == 0)
+	{
+		return;
+	}
+	std::vector<timer_id> ids;
+	ids.swap(lv.slots[slot]);
+	lv.occupied &= ~(uint64_t{1} << slot);
+	for (timer_id id : ids)
+	{
+		auto it = timers.find(id);
+		if (it != timers.end())
+		{
+			place(id, it->second.deadline);
+		}
+	}
+}
+
+uint64_t TimerWheel::next_due() const
+{
+	if (timers.empty())
+	{
+		return 0;
+	}
+	uint64_t due = UINT64_MAX;
+	for (size_t l = 0; l < LEVELS; ++l)
+	{
+		const level& lv = levels[l];
+		if (lv.occupied == 0)
+		{
+			continue;
+		}
+		const size_t shift = SLOT_BITS * l;
+		// level 0 slots are due at their tick, higher ones when the tick enters them and they cascade
+		const uint64_t from = (current_tick >> shift) + 1;
+		const size_t distance = first_occupied(lv.occupied, static_cast<size_t>(from & (SLOTS - 1)));
+		due = (std::min)(due, (from + distance) << shift);
+	}
+	return due;
+}
+
+void TimerWheel::advance(std::unique_lock<std::mutex>& guard, uint64_t target)
+{
+	while (current_tick < target && !stopping)
+	{
+		++current_tick;
+		for (size_t l = LEVELS - 1; l > 0; --l)
+		{
+			if ((current_tick & ((uint64_t{1} << (SLOT_BITS * l)) - 1)) == 0)
+			{
+				cascade(l);
+			}
+		}
+
+		level& lv = levels[0];
+		const size_t slot = static_cast<size_t>(current_tick & (SLOTS - 1));
+		if ((lv.occupied & (uint64_t{1} << slot)) == 0)
+		{
+			continue;
+		}
+		std::vector<timer_id> ids;
+		ids.swap(lv.slots[slot]);
+		lv.occupied &= ~(uint64_t{1} << slot);
+
+		for (timer_id id : ids)
+		{
+			auto it = timers.find(id);
+			if (it == timers.end())
+			{
+				continue;	 // cancelled
+			}
+			if (it->second.deadline > current_tick)
+			{
+				place(id, it->second.deadline);	   // parked at the top level
+				continue;
+			}
+			std::function<void()> action = it->second.action;
+			running = id;
+			guard.unlock();
+			try
+			{
+				action();
+			}
+			catch (std::exception const& e)
+			{
+				spdlog::error("{}: timer action failed | {}", name, e.what());
+			}
+			guard.lock();
+			running = 0;
+			finished.notify_all();
+
+			it = timers.find(id);
+			if (it == timers.end())
+			{
+				continue;
+			}
+			if (it->second.period == 0)
+			{
+				guard.unlock();
+				cancel(id);
+				guard.lock();
+				continue;
+			}
+			// fixed rate, missed periods are skipped
+			it->second.deadline += it->second.period;
+			if (it->second.deadline <= current_tick)
+			{
+				it->second.deadline = current_tick + it->second.period;
+			}
+			place(id, it->second.deadline);
+		}
+	}
+}
+
+void TimerWheel::run()
+{
+	std::unique_lock<decltype(lock)> guard(lock);
+	while (!stopping)
+	{
+		const uint64_t due = next_due();
+		if (due == 0)
+		{
+			changed.wait(guard);
+			continue;
+		}
+		if (due > now_tick())
+		{
+			changed.wait_until(guard, time_of(due));
+		}
+		advance(guard, (std::min)(due, now_tick()));
+	}
+}
+
+TimerWheel::timer_id TimerWheel::schedule(
+	Lifetime lifetime, std::chrono::milliseconds delay, std::chrono::milliseconds period, std::function<void()> action)
+{
+	timer_id id;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		id = next_id++;
+		if (timers.empty())
+		{
+			// nothing is due, catch up with the clock at once instead of tick by tick
+			current_tick = (std::max)(current_tick, now_tick());
+		}
+		const auto ticks = [this](std::chrono::milliseconds d) {
+			const auto count = (std::chrono::duration_cast<clock::duration>(d) + tick - clock::duration(1)) / tick;
+			return static_cast<uint64_t>((std::max)(count, clock::rep(0)));
+		};
+		// counted from now, the wheel may lag behind by the ticks it is about to process
+		const uint64_t deadline = (std::max)(now_tick(), current_tick) + (std::max)(ticks(delay), uint64_t{1});
+		timers.emplace(id, timer{deadline, ticks(period), std::move(action), lifetime, -1});
+		place(id, deadline);
+	}
+	changed.notify_all();
+
+	LifetimeImpl::counter_t termination_action_id;
+	try
+	{
+		termination_action_id = lifetime->add_action([this, id] { cancel(id); });
+	}
+	catch (std::invalid_argument const&)
+	{
+		cancel(id);	   // lifetime is already terminated
+		return id;
+	}
+	bool found;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		auto it = timers.find(id);
+		found = it != timers.end();
+		if (found)
+		{
+			it->second.termination_action_id = termination_action_id;
+		}
+	}
+	if (!found)
+	{
+		// fired or cancelled before the action was recorded
+		lifetime->remove_action(termination_action_id);
+	}
+	return id;
+}
+
+void TimerWheel::cancel(timer_id id)
+{
+	// released outside of the lock, they may hold the last references to user state
+	Lifetime lifetime{Lifetime::Eternal()};
+	std::function<void()> action;
+	LifetimeImpl::counter_t termination_action_id = -1;
+	{
+		std::unique_lock<decltype(lock)> guard(lock);
+		auto it = timers.find(id);
+		if (it != timers.end())
+		{
+			lifetime = std::move(it->second.lifetime);
+			action = std::move(it->second.action);
+			termination_action_id = it->second.termination_action_id;
+			timers.erase(it);
+		}
+		if (std::this_thread::get_id() != thread.get_id())
+		{
+			finished.wait(guard, [this, id] { return running != id; });
+		}
+	}
+	// no-op when cancelled by the termination itself
+	if (termination_action_id >= 0)
+	{
+		lifetime->remove_action(termination_action_id);
+	}
+}
+
+size_t TimerWheel::get_timers_count() const
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	return timers.size();
+}
+}	 // namespace rd
\ No newline at end of file
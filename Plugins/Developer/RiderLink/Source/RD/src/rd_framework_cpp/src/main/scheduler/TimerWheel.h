@@ -0,0 +1,139 @@
+#ifndef RD_CPP_TIMERWHEEL_H
+#define RD_CPP_TIMERWHEEL_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "lifetime/Lifetime.h"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Runs delayed and periodic actions of any number of users on a single thread.
+ * Timers are kept in a hierarchical wheel of [LEVELS] levels with [SLOTS] slots each, so adding, cancelling and
+ * firing a timer costs O(1). The thread sleeps until the next slot which holds a timer.
+ * Actions are executed on the wheel's thread and must be short, e.g. send a ping or queue work elsewhere.
+ */
+class RD_FRAMEWORK_API TimerWheel
+{
+public:
+	using clock = std::chrono::steady_clock;
+	using timer_id = uint64_t;
+
+private:
+	static constexpr size_t SLOT_BITS = 6;
+	static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+	static constexpr size_t LEVELS = 4;
+
+	struct timer
+	{
+		uint64_t deadline;
+		uint64_t period;
+		std::function<void()> action;
+		Lifetime lifetime;
+		LifetimeImpl::counter_t termination_action_id;
+	};
+
+	struct level
+	{
+		std::array<std::vector<timer_id>, SLOTS> slots;
+		uint64_t occupied = 0;
+	};
+
+	std::string name;
+	clock::duration tick;
+	clock::time_point start = clock::now();
+
+	// region guarded by lock
+
+	mutable std::mutex lock;
+	std::condition_variable changed;
+	std::condition_variable finished;
+
+	std::array<level, LEVELS> levels;
+
+	/**
+	 * \brief Timers are removed from here when cancelled and skipped lazily when their slot comes.
+	 */
+	std::unordered_map<timer_id, timer> timers;
+
+	timer_id next_id = 1;
+	uint64_t current_tick = 0;
+	timer_id running = 0;
+	bool stopping = false;
+
+	// endregion
+
+	std::thread thread;
+
+	uint64_t now_tick() const;
+
+	clock::time_point time_of(uint64_t tick_number) const;
+
+	void place(timer_id id, uint64_t deadline);
+
+	void cascade(size_t level_index);
+
+	/**
+	 * \brief Tick at which the next slot holding a timer comes due, or 0 if there are no timers.
+	 */
+	uint64_t next_due() const;
+
+	void advance(std::unique_lock<std::mutex>& guard, uint64_t target);
+
+	void run();
+
+public:
+	// region ctor/dtor
+
+	explicit TimerWheel(std::string name, clock::duration tick = std::chrono::milliseconds(1));
+
+	TimerWheel(TimerWheel const&) = delete;
+
+	TimerWheel& operator=(TimerWheel const&) = delete;
+
+	virtual ~TimerWheel();
+
+	// endregion
+
+	/**
+	 * \brief The wheel shared by all wires of the process.
+	 */
+	static TimerWheel& instance();
+
+	/**
+	 * \brief Runs [action] after [delay], then every [period] unless it is zero, until cancelled or [lifetime] terminates.
+	 *
+	 * \return id to [cancel] the timer with
+	 */
+	timer_id schedule(Lifetime lifetime, std::chrono::milliseconds delay, std::chrono::milliseconds period,
+		std::function<void()> action);
+
+	/**
+	 * \brief Cancels the timer, once it returns the action is not running and won't run again
+	 * (unless it is called by the action itself).
+	 */
+	void cancel(timer_id id);
+
+	size_t get_timers_count() const;
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_TIMERWHEEL_H
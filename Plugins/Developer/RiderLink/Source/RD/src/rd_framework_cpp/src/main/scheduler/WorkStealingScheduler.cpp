@@ -0,0 +1,276 @@
+#include "WorkStealingScheduler.h"
+
+#include "util/core_util.h"
+#include "util/thread_util.h"
+
+#include "spdlog/include/spdlog/sinks/stdout_color_sinks.h"
+
+#include <algorithm>
+
+namespace rd
+{
+constexpr size_t WorkStealingScheduler::MAX_THREADS;
+constexpr size_t WorkStealingScheduler::STRAND_SHARDS;
+constexpr size_t WorkStealingScheduler::STRAND_BATCH;
+
+namespace
+{
+thread_local WorkStealingScheduler const* current_scheduler = nullptr;
+thread_local size_t current_worker = 0;
+}	 // namespace
+
+WorkStealingScheduler::WorkStealingScheduler(Lifetime lifetime, std::string name, size_t threads)
+	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic))
+	, name(std::move(name))
+	, lifetime(lifetime)
+{
+	out_of_order_execution = true;
+
+	if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+	threads = (std::min)((std::max)(threads, size_t{1}), MAX_THREADS);
+
+	workers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i)
+	{
+		workers.push_back(std::make_unique<worker>());
+	}
+	for (size_t i = 0; i < threads; ++i)
+	{
+		workers[i]->thread = std::thread([this, i] {
+			rd::util::set_thread_name(this->name.c_str());
+			current_scheduler = this;
+			current_worker = i;
+			run(i);
+		});
+	}
+	thread_id = workers[0]->thread.get_id();
+
+	termination_action_id = lifetime->add_action([this]() { stop(); });
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+	lifetime->remove_action(termination_action_id);
+	stop();
+	for (auto& w : workers)
+	{
+		if (w->thread.joinable())
+		{
+			w->thread.detach();
+		}
+	}
+}
+
+size_t WorkStealingScheduler::get_threads_count() const
+{
+	return workers.size();
+}
+
+void WorkStealingScheduler::submit(std::function<void()> task)
+{
+	// own deque when queued from a worker, the rest are spread over all of them
+	const size_t index = current_scheduler == this ? current_worker : next_worker++ % workers.size();
+	++tasks_queued;
+	{
+		std::lock_guard<decltype(worker::lock)> guard(workers[index]->lock);
+		workers[index]->tasks.push_back(std::move(task));
+	}
+	if (sleeping > 0)
+	{
+		std::lock_guard<decltype(idle_lock)> guard(idle_lock);
+		work_queued.notify_one();
+	}
+}
+
+bool WorkStealingScheduler::take(size_t index, std::function<void()>& task)
+{
+	{
+		worker& own = *workers[index];
+		std::lock_guard<decltype(worker::lock)> guard(own.lock);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			--tasks_queued;
+			return true;
+		}
+	}
+	for (size_t k = 1; k < workers.size(); ++k)
+	{
+		worker& victim = *workers[(index + k) % workers.size()];
+		std::lock_guard<decltype(worker::lock)> guard(victim.lock);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			--tasks_queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingScheduler::run(size_t index)
+{
+	std::function<void()> task;
+	while (true)
+	{
+		if (take(index, task))
+		{
+			execute(task);
+			task = nullptr;
+			finished();
+			continue;
+		}
+
+		std::unique_lock<decltype(idle_lock)> guard(idle_lock);
+		++sleeping;
+		work_queued.wait(guard, [this] { return tasks_queued > 0 || (stopping && tasks_submitting == 0); });
+		--sleeping;
+		if (tasks_queued == 0 && stopping && tasks_submitting == 0)
+		{
+			return;
+		}
+	}
+}
+
+void WorkStealingScheduler::run_strand(size_t key)
+{
+	strand_shard& shard = strand_shards[key % STRAND_SHARDS];
+	for (size_t i = 0; i < STRAND_BATCH; ++i)
+	{
+		std::function<void()> action;
+		{
+			std::lock_guard<decltype(strand_shard::lock)> guard(shard.lock);
+			auto it = shard.strands.find(key);
+			if (it->second.tasks.empty())
+			{
+				shard.strands.erase(it);
+				return;
+			}
+			action = std::move(it->second.tasks.front());
+			it->second.tasks.pop_front();
+		}
+		execute(action);
+	}
+	// let other work in before going on with this key
+	++tasks_executing;
+	submit([this, key] { run_strand(key); });
+}
+
+void WorkStealingScheduler::execute(std::function<void()>& action)
+{
+	try
+	{
+		action();
+	}
+	catch (std::exception const& e)
+	{
+		log->error("Background task failed, scheduler={} | {}", name, e.what());
+	}
+}
+
+void WorkStealingScheduler::finished()
+{
+	if (--tasks_executing == 0)
+	{
+		std::lock_guard<decltype(idle_lock)> guard(idle_lock);
+		drained.notify_all();
+	}
+}
+
+bool WorkStealingScheduler::accept()
+{
+	std::lock_guard<decltype(idle_lock)> guard(idle_lock);
+	if (stopping)
+	{
+		log->debug("Scheduler {} is stopped, action dropped", name);
+		return false;
+	}
+	++tasks_executing;
+	++tasks_submitting;
+	return true;
+}
+
+void WorkStealingScheduler::submitted()
+{
+	if (--tasks_submitting == 0 && stopping)
+	{
+		// the threads of a stopping scheduler wait for it before they quit
+		std::lock_guard<decltype(idle_lock)> guard(idle_lock);
+		work_queued.notify_all();
+	}
+}
+
+void WorkStealingScheduler::queue(std::function<void()> action)
+{
+	if (accept())
+	{
+		submit(std::move(action));
+		submitted();
+	}
+}
+
+void WorkStealingScheduler::queue_ordered(size_t key, std::function<void()> action)
+{
+	if (!accept())
+	{
+		return;
+	}
+	bool idle_strand;
+	{
+		strand_shard& shard = strand_shards[key % STRAND_SHARDS];
+		std::lock_guard<decltype(strand_shard::lock)> guard(shard.lock);
+		// a strand exists while its task is queued or running, that task picks the action up
+		auto it = shard.strands.find(key);
+		idle_strand = it == shard.strands.end();
+		if (idle_strand)
+		{
+			it = shard.strands.emplace(key, strand{}).first;
+		}
+		it->second.tasks.push_back(std::move(action));
+	}
+	if (idle_strand)
+	{
+		submit([this, key] { run_strand(key); });
+	}
+	else
+	{
+		// the task of the strand runs the action, it's counted already
+		finished();
+	}
+	submitted();
+}
+
+void WorkStealingScheduler::flush()
+{
+	RD_ASSERT_MSG(!is_active(), "Can't flush this scheduler in a reentrant way: we are inside queued item's execution");
+
+	std::unique_lock<decltype(idle_lock)> guard(idle_lock);
+	drained.wait(guard, [this] { return tasks_executing == 0; });
+}
+
+void WorkStealingScheduler::stop()
+{
+	{
+		std::lock_guard<decltype(idle_lock)> guard(idle_lock);
+		stopping = true;
+		work_queued.notify_all();
+	}
+	for (auto& w : workers)
+	{
+		if (w->thread.joinable() && w->thread.get_id() != std::this_thread::get_id())
+		{
+			w->thread.join();
+		}
+	}
+}
+
+bool WorkStealingScheduler::is_active() const
+{
+	return current_scheduler == this;
+}
+}	 // namespace rd
\ No newline at end of file
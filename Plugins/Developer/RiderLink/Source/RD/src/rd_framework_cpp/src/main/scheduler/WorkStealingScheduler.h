@@ -0,0 +1,145 @@
+#ifndef RD_CPP_WORKSTEALINGSCHEDULER_H
+#define RD_CPP_WORKSTEALINGSCHEDULER_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "scheduler/base/IScheduler.h"
+#include "lifetime/Lifetime.h"
+#include "spdlog/spdlog.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Executes actions on a fixed number of threads, for entities which allow [out_of_order_execution].
+ * Each thread has its own deque: it queues to and takes from its back, idle threads steal from the front of others.
+ * Actions queued with [queue_ordered] run one at a time per key, in the order they were queued.
+ */
+class RD_FRAMEWORK_API WorkStealingScheduler : public IScheduler
+{
+	static constexpr size_t MAX_THREADS = 64;
+	static constexpr size_t STRAND_SHARDS = 16;
+
+	/**
+	 * \brief How many actions of one key run in a row before the thread moves on to others.
+	 */
+	static constexpr size_t STRAND_BATCH = 16;
+
+	std::shared_ptr<spdlog::logger> log;
+	std::string name;
+
+	struct worker
+	{
+		std::mutex lock;
+		std::deque<std::function<void()>> tasks;
+		std::thread thread;
+	};
+
+	std::vector<std::unique_ptr<worker>> workers;
+
+	/**
+	 * \brief Actions of one key, at most one task draining them is queued at a time.
+	 */
+	struct strand
+	{
+		std::deque<std::function<void()>> tasks;
+	};
+
+	struct strand_shard
+	{
+		std::mutex lock;
+		std::unordered_map<size_t, strand> strands;
+	};
+
+	std::array<strand_shard, STRAND_SHARDS> strand_shards;
+
+	/**
+	 * \brief Tasks sitting in the deques, and tasks queued but not finished yet.
+	 */
+	std::atomic<size_t> tasks_queued{0};
+	std::atomic<size_t> tasks_executing{0};
+
+	/**
+	 * \brief Tasks accepted by [accept] which aren't in a deque yet, the threads don't quit until they are.
+	 */
+	std::atomic<size_t> tasks_submitting{0};
+
+	std::atomic<size_t> sleeping{0};
+	std::atomic<size_t> next_worker{0};
+	std::atomic<bool> stopping{false};
+
+	std::mutex idle_lock;
+	std::condition_variable work_queued;
+	std::condition_variable drained;
+
+	LifetimeImpl::counter_t termination_action_id{};
+
+	/**
+	 * \brief Counts an action queued from outside unless the scheduler is stopping. [stopping] is checked under
+	 * [idle_lock] which [stop] sets it under, so an accepted action always runs. Must be followed by [submitted].
+	 */
+	bool accept();
+
+	void submitted();
+
+	void submit(std::function<void()> task);
+
+	bool take(size_t index, std::function<void()>& task);
+
+	void run(size_t index);
+
+	void run_strand(size_t key);
+
+	void execute(std::function<void()>& action);
+
+	void finished();
+
+	/**
+	 * \brief Executes the actions queued so far and joins the threads, actions queued afterwards are dropped.
+	 */
+	void stop();
+
+public:
+	Lifetime lifetime;
+
+	// region ctor/dtor
+
+	/**
+	 * \param threads number of threads, [std::thread::hardware_concurrency] if 0
+	 */
+	WorkStealingScheduler(Lifetime lifetime, std::string name, size_t threads = 0);
+
+	virtual ~WorkStealingScheduler();
+
+	// endregion
+
+	size_t get_threads_count() const;
+
+	void queue(std::function<void()> action) override;
+
+	void queue_ordered(size_t key, std::function<void()> action) override;
+
+	void flush() override;
+
+	bool is_active() const override;
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_WORKSTEALINGSCHEDULER_H
@@ -17,6 +17,11 @@ void IScheduler::assert_thread() const
 	}
 }
 
+void IScheduler::queue_ordered(size_t /*key*/, std::function<void()> action)
+{
+	queue(std::move(action));
+}
+
 void IScheduler::invoke_or_queue(std::function<void()> action)
 {
 	if (is_active())
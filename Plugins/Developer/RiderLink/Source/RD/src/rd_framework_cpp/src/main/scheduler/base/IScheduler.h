@@ -36,6 +36,15 @@ public:
 	 */
 	virtual void queue(std::function<void()> action) = 0;
 
+	/**
+	 * \brief Queues [action] to be executed after every action queued earlier with the same [key].
+	 * Only schedulers with [out_of_order_execution] have to care, the rest execute everything in order anyway.
+	 *
+	 * \param key actions with different keys may run concurrently
+	 * \param action to be queued.
+	 */
+	virtual void queue_ordered(size_t key, std::function<void()> action);
+
 	// TO-DO
 	bool out_of_order_execution = false;
 
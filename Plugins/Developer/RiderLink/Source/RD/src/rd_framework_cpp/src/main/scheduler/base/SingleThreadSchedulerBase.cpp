@@ -1,55 +1,160 @@
 #include "SingleThreadSchedulerBase.h"
 
 #include "util/core_util.h"
+#include "util/thread_util.h"
 
-#include "ctpl_stl.h"
 #include "spdlog/include/spdlog/sinks/stdout_color_sinks.h"
 
 namespace rd
 {
-SingleThreadSchedulerBase::PoolTask::PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler)
-	: f(std::move(f)), scheduler(scheduler)
+constexpr size_t SingleThreadSchedulerBase::MAX_FREE_NODES;
+
+SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name)
+	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic)), name(std::move(name))
+{
+	thread = std::thread([this] {
+		rd::util::set_thread_name(this->name.c_str());
+		run();
+	});
+	thread_id = thread.get_id();
+}
+
+void SingleThreadSchedulerBase::run()
 {
+	std::unique_lock<decltype(lock)> guard(lock);
+	while (true)
+	{
+		if (head == nullptr)
+		{
+			if (stopping)
+			{
+				return;
+			}
+			waiting_for_work = true;
+			work_queued.wait(guard, [this] { return head != nullptr || stopping; });
+			waiting_for_work = false;
+			continue;
+		}
+
+		task_node* batch = head;
+		head = tail = nullptr;
+		guard.unlock();
+
+		uint32_t executed = 0;
+		for (task_node* node = batch; node != nullptr; node = node->next)
+		{
+			execute(*node);
+			++executed;
+		}
+
+		guard.lock();
+		recycle(batch);
+		tasks_executing -= executed;
+		if (tasks_executing == 0)
+		{
+			drained.notify_all();
+		}
+	}
 }
 
-void SingleThreadSchedulerBase::PoolTask::operator()(int id) const
+void SingleThreadSchedulerBase::execute(task_node& node)
 {
 	try
 	{
-		f();
-		--scheduler->tasks_executing;
+		node.action();
 	}
 	catch (std::exception const& e)
 	{
-		scheduler->log->error("Background task failed, scheduler={}, thread_id={} | {}", scheduler->name, id, e.what());
-		--scheduler->tasks_executing;
+		log->error("Background task failed, scheduler={} | {}", name, e.what());
 	}
+	// captured state is released here, not under the lock
+	node.action = nullptr;
 }
 
-SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name)
-	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic))
-	, name(std::move(name))
-	, pool(std::make_unique<ctpl::thread_pool>(1))
+void SingleThreadSchedulerBase::recycle(task_node* batch)
 {
-	RD_ASSERT_THROW_MSG(pool->size() == 1, "Thread pool wasn't properly initalized");
-	thread_id = pool->get_thread(0).get_id();
+	while (batch != nullptr)
+	{
+		task_node* next = batch->next;
+		if (free_nodes_count < MAX_FREE_NODES)
+		{
+			batch->next = free_nodes;
+			free_nodes = batch;
+			++free_nodes_count;
+		}
+		else
+		{
+			delete batch;
+		}
+		batch = next;
+	}
+}
+
+void SingleThreadSchedulerBase::stop()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		stopping = true;
+	}
+	work_queued.notify_all();
+	// stopped from one of its own actions: the thread finishes the queue and exits by itself
+	if (thread.joinable() && !is_active())
+	{
+		thread.join();
+	}
 }
 
 void SingleThreadSchedulerBase::flush()
 {
 	RD_ASSERT_MSG(!is_active(), "Can't flush this scheduler in a reentrant way: we are inside queued item's execution");
 
-	while (tasks_executing != 0)
-	{
-		std::this_thread::yield();
-	}
+	std::unique_lock<decltype(lock)> guard(lock);
+	drained.wait(guard, [this] { return tasks_executing == 0; });
 }
 
 void SingleThreadSchedulerBase::queue(std::function<void()> action)
 {
-	++tasks_executing;
-	PoolTask task(action, this);
-	pool->push(std::move(task));
+	bool wake = false;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (stopping)
+		{
+			log->debug("Scheduler {} is stopped, action dropped", name);
+			return;
+		}
+
+		task_node* node = free_nodes;
+		if (node != nullptr)
+		{
+			free_nodes = node->next;
+			--free_nodes_count;
+		}
+		else
+		{
+			node = new task_node;
+		}
+		node->action = std::move(action);
+		node->next = nullptr;
+
+		if (tail != nullptr)
+		{
+			tail->next = node;
+		}
+		else
+		{
+			head = node;
+		}
+		tail = node;
+		++tasks_executing;
+
+		// one notification is enough until the thread wakes up
+		wake = waiting_for_work;
+		waiting_for_work = false;
+	}
+	if (wake)
+	{
+		work_queued.notify_one();
+	}
 }
 
 bool SingleThreadSchedulerBase::is_active() const
@@ -57,5 +162,19 @@ bool SingleThreadSchedulerBase::is_active() const
 	return thread_id == std::this_thread::get_id();
 }
 
-SingleThreadSchedulerBase::~SingleThreadSchedulerBase() = default;
+SingleThreadSchedulerBase::~SingleThreadSchedulerBase()
+{
+	stop();
+	if (thread.joinable())
+	{
+		thread.detach();
+	}
+	recycle(head);
+	while (free_nodes != nullptr)
+	{
+		task_node* next = free_nodes->next;
+		delete free_nodes;
+		free_nodes = next;
+	}
+}
 }	 // namespace rd
\ No newline at end of file
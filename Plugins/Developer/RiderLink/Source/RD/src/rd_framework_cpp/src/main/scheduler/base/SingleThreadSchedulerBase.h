@@ -10,37 +10,70 @@
 #include "lifetime/Lifetime.h"
 #include "spdlog/spdlog.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include <rd_framework_export.h>
 
-namespace ctpl
-{
-class thread_pool;
-}
-
 namespace rd
 {
+/**
+ * \brief Executes queued actions one by one on its own thread.
+ */
 class RD_FRAMEWORK_API SingleThreadSchedulerBase : public IScheduler
 {
 protected:
 	std::shared_ptr<spdlog::logger> log;
 	std::string name;
 
-	std::atomic_uint32_t tasks_executing{0};
-	std::atomic_uint32_t active{0};
-	std::unique_ptr<ctpl::thread_pool> pool;
-
-	class PoolTask
+	/**
+	 * \brief Queued action, nodes of executed actions are kept in [free_nodes] for the next ones.
+	 */
+	struct task_node
 	{
-		std::function<void()> f;
-		SingleThreadSchedulerBase* scheduler;
+		std::function<void()> action;
+		task_node* next = nullptr;
+	};
 
-	public:
-		explicit PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler);
+	static constexpr size_t MAX_FREE_NODES = 1024;
 
-		void operator()(int id) const;
-	};
+	// region guarded by lock
+
+	std::mutex lock;
+	task_node* head = nullptr;
+	task_node* tail = nullptr;
+	task_node* free_nodes = nullptr;
+	size_t free_nodes_count = 0;
+
+	/**
+	 * \brief Number of actions queued or being executed, [flush] waits for it to drop to zero.
+	 */
+	uint32_t tasks_executing = 0;
+	bool waiting_for_work = false;
+	bool stopping = false;
+
+	// endregion
+
+	std::condition_variable work_queued;
+	std::condition_variable drained;
+
+	std::thread thread;
+
+	/**
+	 * \brief Takes everything queued so far at once and executes it outside the lock, until [stop].
+	 */
+	void run();
+
+	void execute(task_node& node);
+
+	void recycle(task_node* batch);
+
+	/**
+	 * \brief Executes the actions queued so far and joins the thread, actions queued afterwards are dropped.
+	 */
+	void stop();
 
 public:
 	// region ctor/dtor
@@ -98,7 +98,7 @@ optional<InternedAny> Serializers::readAny(SerializationCtx& ctx, Buffer& buffer
 	{
 		return nullopt;
 	}
-	int32_t size = buffer.read_integral<int32_t>();
+	int32_t size = buffer.read_fixed_integral<int32_t>();
 	buffer.check_available(static_cast<size_t>(size));
 
 	if (readers.count(id) == 0)
@@ -122,13 +122,13 @@ void Serializers::writePolymorphicNullable(SerializationCtx& ctx, Buffer& buffer
 	real_rd_id(value).write(buffer);
 
 	int32_t length_tag_position = static_cast<int32_t>(buffer.get_position());
-	buffer.write_integral<int32_t>(0);
+	buffer.write_fixed_integral<int32_t>(0);
 	int32_t object_start_position = static_cast<int32_t>(buffer.get_position());
 	real_write(ctx, buffer, value);
 	//		value.write(ctx, buffer);
 	int32_t object_end_position = static_cast<int32_t>(buffer.get_position());
 	buffer.set_position(static_cast<size_t>(length_tag_position));
-	buffer.write_integral<int32_t>(object_end_position - object_start_position);
+	buffer.write_fixed_integral<int32_t>(object_end_position - object_start_position);
 	buffer.set_position(static_cast<size_t>(object_end_position));
 }
 
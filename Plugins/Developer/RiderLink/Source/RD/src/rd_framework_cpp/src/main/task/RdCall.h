@@ -73,11 +73,8 @@ public:
 	{
 		auto task = start_internal(request, true, &SynchronousScheduler::Instance());
 		auto time_at_start = std::chrono::system_clock::now();
-		while (!task.has_value() && !(*bind_lifetime)->is_terminated() &&
-			   ((std::chrono::system_clock::now() - time_at_start) < timeout))
-		{
-			std::this_thread::yield();
-		}
+		// termination of the lifetime cancels the task, which wakes us up as well
+		task.wait(timeout);
 		spdlog::debug("Time elapsed: {}, has_value={}", to_string(std::chrono::system_clock::now() - time_at_start),
 			to_string(task.has_value()));
 		task.value_or_throw().unwrap();	   // check for existing value
@@ -84,6 +84,16 @@ public:
 		return impl->result.has_value();
 	}
 
+	/**
+	 * \brief Blocks until the task has a result or [timeout] expires.
+	 *
+	 * \return whether the task has a result
+	 */
+	bool wait(std::chrono::milliseconds timeout) const
+	{
+		return impl->wait_for(timeout);
+	}
+
 	const TRes& value_or_throw() const
 	{
 		if (impl->result.has_value())
@@ -6,6 +6,10 @@
 
 #include "thirdparty.hpp"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 namespace rd
 {
 template <typename, typename>
@@ -19,9 +23,38 @@ class RdTaskImpl
 private:
 	mutable Property<RdTaskResult<T, S>> result;
 
+	/**
+	 * \brief Signalled once [result] has a value, whoever sets it.
+	 */
+	mutable std::mutex lock;
+	mutable std::condition_variable result_set;
+	bool has_result = false;
+
 public:
 	template <typename, typename>
 	friend class ::rd::RdTask;
+
+	RdTaskImpl()
+	{
+		// a property only fires once it has a value
+		result.advise(Lifetime::Eternal(), [this](RdTaskResult<T, S> const&) {
+			{
+				std::lock_guard<decltype(lock)> guard(lock);
+				has_result = true;
+			}
+			result_set.notify_all();
+		});
+	}
+
+	RdTaskImpl(RdTaskImpl const&) = delete;
+
+	RdTaskImpl& operator=(RdTaskImpl const&) = delete;
+
+	bool wait_for(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<decltype(lock)> guard(lock);
+		return result_set.wait_for(guard, timeout, [this] { return has_result; });
+	}
 };
 }	 // namespace detail
 }	 // namespace rd
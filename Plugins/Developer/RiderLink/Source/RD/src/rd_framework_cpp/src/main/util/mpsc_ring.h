@@ -0,0 +1,118 @@
+#ifndef RD_CPP_MPSC_RING_H
+#define RD_CPP_MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Bounded lock-free queue for many producers and a single consumer.
+ * Every cell carries a sequence number telling whether it is free for the producer of a given position
+ * or ready for the consumer, so producers only contend on one atomic position.
+ * \tparam T movable value type, default constructible.
+ */
+template <typename T>
+class mpsc_ring
+{
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	// keep the producer and the consumer positions on separate cache lines
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	std::unique_ptr<cell[]> cells;
+	const size_t mask;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos{0};
+	alignas(CACHE_LINE_SIZE) size_t dequeue_pos = 0;
+
+public:
+	// region ctor/dtor
+
+	/**
+	 * \param capacity must be a power of two
+	 */
+	explicit mpsc_ring(size_t capacity) : cells(new cell[capacity]), mask(capacity - 1)
+	{
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	mpsc_ring(mpsc_ring const&) = delete;
+
+	mpsc_ring& operator=(mpsc_ring const&) = delete;
+
+	// endregion
+
+	size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	/**
+	 * \brief Safe to call from any thread.
+	 * \return false if the ring is full, [value] is left untouched then.
+	 */
+	bool try_push(T& value)
+	{
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		cell* c;
+		while (true)
+		{
+			c = &cells[pos & mask];
+			const size_t seq = c->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		c->value = std::move(value);
+		c->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief Must only be called from the consumer thread.
+	 * \return false if the ring is empty or the next value is still being written by its producer.
+	 */
+	bool try_pop(T& value)
+	{
+		cell* c = &cells[dequeue_pos & mask];
+		if (c->sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+		{
+			return false;
+		}
+		value = std::move(c->value);
+		c->value = T{};
+		c->sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+		++dequeue_pos;
+		return true;
+	}
+};
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_MPSC_RING_H
@@ -5,18 +5,23 @@
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+
 namespace rd
 {
-size_t ByteBufferAsyncProcessor::INITIAL_CAPACITY = 1024 * 1024;
+constexpr size_t ByteBufferAsyncProcessor::RING_CAPACITY;
+constexpr size_t ByteBufferAsyncProcessor::SLAB_SIZE;
+constexpr size_t ByteBufferAsyncProcessor::MAX_POOLED_SLABS;
+constexpr size_t ByteBufferAsyncProcessor::MAX_POOLED_SLAB_CAPACITY;
 
 std::shared_ptr<spdlog::logger> ByteBufferAsyncProcessor::logger =
 	spdlog::stderr_color_mt<spdlog::synchronous_factory>("byteBufferLog", spdlog::color_mode::automatic);
 
 ByteBufferAsyncProcessor::ByteBufferAsyncProcessor(
-	std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor)
+	std::string id, std::function<bool(Buffer::ByteArray&, sequence_number_t)> processor)
 	: id(std::move(id)), processor(std::move(processor))
 {
-	data.reserve(INITIAL_CAPACITY);
+	free_slabs.reserve(MAX_POOLED_SLABS);
 }
 
 void ByteBufferAsyncProcessor::cleanup0()
@@ -67,13 +72,60 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 	return success;
 }
 
-void ByteBufferAsyncProcessor::add_data(std::vector<Buffer::ByteArray>&& new_data)
+// must be called under queue_lock
+size_t ByteBufferAsyncProcessor::drain_data()
+{
+	size_t drained = 0;
+	Buffer::ByteArray item;
+	while (data.try_pop(item))
+	{
+		queue.push_back(std::move(item));
+		++drained;
+	}
+	if (drained > 0)
+	{
+		data_size.fetch_sub(drained, std::memory_order_acq_rel);
+	}
+	return drained;
+}
+
+// must be called under queue_lock
+void ByteBufferAsyncProcessor::drop_acknowledged(sequence_number_t seqn)
 {
-	std::lock_guard<decltype(queue_lock)> guard(queue_lock);
-	std::move(new_data.begin(), new_data.end(), std::back_inserter(queue));
-	//		for (auto &&item : new_data) {
-	//			queue.emplace(std::move(item));
-	//		}
+	while (current_seqn <= seqn && !pending_queue.empty())
+	{
+		release_slab(std::move(pending_queue.front()));
+		pending_queue.pop_front();
+		++current_seqn;
+	}
+}
+
+void ByteBufferAsyncProcessor::release_slab(Buffer::ByteArray slab)
+{
+	if (slab.capacity() > MAX_POOLED_SLAB_CAPACITY)
+	{
+		return;
+	}
+	std::lock_guard<decltype(pool_lock)> guard(pool_lock);
+	if (free_slabs.size() < MAX_POOLED_SLABS)
+	{
+		free_slabs.emplace_back(std::move(slab));
+	}
+}
+
+Buffer::ByteArray ByteBufferAsyncProcessor::acquire_slab()
+{
+	Buffer::ByteArray slab;
+	{
+		std::lock_guard<decltype(pool_lock)> guard(pool_lock);
+		if (!free_slabs.empty())
+		{
+			slab = std::move(free_slabs.back());
+			free_slabs.pop_back();
+		}
+	}
+	slab.resize((std::max)(slab.capacity(), SLAB_SIZE));
+	return slab;
 }
 
 bool ByteBufferAsyncProcessor::reprocess()
@@ -88,14 +140,10 @@ bool ByteBufferAsyncProcessor::reprocess()
 
 		logger->debug("{}: reprocessing waited for main processing", id);
 
-		while (current_seqn <= acknowledged_seqn)
-		{
-			pending_queue.pop_front();
-			++current_seqn;
-		}
+		drop_acknowledged(acknowledged_seqn);
 		for (int i = 0; i < pending_queue.size(); ++i)
 		{
-			auto const& item = pending_queue[i];
+			auto& item = pending_queue[i];
 			if (!processor(item, current_seqn + i))
 			{
 				return false;
@@ -105,7 +153,7 @@ bool ByteBufferAsyncProcessor::reprocess()
 	return true;
 }
 
-void ByteBufferAsyncProcessor::process()
+void ByteBufferAsyncProcessor::process(sequence_number_t seqn_to_drop)
 {
 	{
 		std::lock_guard<decltype(queue_lock)> guard(queue_lock);
@@ -114,6 +162,8 @@ void ByteBufferAsyncProcessor::process()
 
 		logger->debug("{}: processing started", id);
 
+		drop_acknowledged(seqn_to_drop);
+
 		while (!queue.empty() && processor(queue.front(), max_sent_seqn + 1))
 		{
 			++max_sent_seqn;
@@ -131,8 +181,11 @@ void ByteBufferAsyncProcessor::ThreadProc()
 	rd::util::set_thread_name(id.empty() ? "ByteBufferAsyncProcessor Thread" : id.c_str());
 	async_thread_id = std::this_thread::get_id();
 
+	sequence_number_t seqn_to_drop = 0;
+
 	while (true)
 	{
+		bool should_process = false;
 		{
 			std::lock_guard<decltype(lock)> guard(lock);
 
@@ -141,7 +194,7 @@ void ByteBufferAsyncProcessor::ThreadProc()
 				return;
 			}
 
-			while (data.empty() || interrupt_balance != 0)
+			while (data_size.load(std::memory_order_acquire) == 0 && !(flush_requested && interrupt_balance == 0))
 			{
 				if (state >= StateKind::Stopping)
 				{
@@ -156,13 +209,34 @@ void ByteBufferAsyncProcessor::ThreadProc()
 					return;
 				}
 			}
-			add_data(std::move(data));
-			data.clear();
+			should_process = interrupt_balance == 0;
+			if (should_process)
+			{
+				flush_requested = false;
+			}
+			seqn_to_drop = acknowledged_seqn;
+		}
+
+		// drained while paused as well, so producers never wait for a reconnect
+		size_t drained;
+		{
+			std::lock_guard<decltype(queue_lock)> guard(queue_lock);
+			drained = drain_data();
+		}
+
+		if (!should_process)
+		{
+			if (drained == 0)
+			{
+				// a producer has reserved a cell but not written it yet
+				std::this_thread::yield();
+			}
+			continue;
 		}
 
 		try
 		{
-			process();
+			process(seqn_to_drop);
 		}
 		catch (std::exception const& e)
 		{
@@ -200,16 +274,27 @@ bool ByteBufferAsyncProcessor::terminate(time_t timeout)
 
 void ByteBufferAsyncProcessor::put(Buffer::ByteArray new_data)
 {
+	if (state >= StateKind::Stopping)
+	{
+		return;
+	}
+	while (!data.try_push(new_data))
 	{
-		std::lock_guard<decltype(lock)> guard(lock);
-
 		if (state >= StateKind::Stopping)
 		{
 			return;
 		}
-		data.emplace_back(std::move(new_data));
+		// ring is full, the async thread is already awake and draining it
+		std::this_thread::yield();
+	}
+	if (data_size.fetch_add(1, std::memory_order_acq_rel) == 0)
+	{
+		// taking the lock makes sure the async thread is either waiting or going to see the new size
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+		}
+		cv.notify_all();
 	}
-	cv.notify_all();
 }
 
 void ByteBufferAsyncProcessor::pause(const std::string& reason)
@@ -238,6 +323,7 @@ void ByteBufferAsyncProcessor::resume()
 		reprocess();
 
 		--interrupt_balance;
+		flush_requested = true;
 
 		logger->debug("{} resumed", id);
 	}
@@ -260,6 +346,38 @@ void ByteBufferAsyncProcessor::acknowledge(sequence_number_t seqn)
 	}
 }
 
+bool ByteBufferAsyncProcessor::any_unacknowledged(std::function<bool(Buffer::ByteArray const&)> const& predicate)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	std::lock_guard<decltype(queue_lock)> queue_guard(queue_lock);
+
+	drain_data();
+	drop_acknowledged(acknowledged_seqn);
+	return std::any_of(pending_queue.begin(), pending_queue.end(), predicate) ||
+		   std::any_of(queue.begin(), queue.end(), predicate);
+}
+
+size_t ByteBufferAsyncProcessor::discard_unacknowledged(std::function<bool(Buffer::ByteArray const&)> const& predicate)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	std::lock_guard<decltype(queue_lock)> queue_guard(queue_lock);
+
+	drain_data();
+	drop_acknowledged(acknowledged_seqn);
+
+	const size_t sent = pending_queue.size();
+	pending_queue.erase(std::remove_if(pending_queue.begin(), pending_queue.end(), predicate), pending_queue.end());
+	// pending packages are numbered from current_seqn on
+	const size_t discarded_sent = sent - pending_queue.size();
+	max_sent_seqn -= static_cast<sequence_number_t>(discarded_sent);
+
+	const size_t queued = queue.size();
+	queue.erase(std::remove_if(queue.begin(), queue.end(), predicate), queue.end());
+
+	logger->debug("{}: discarded {} sent and {} queued packages", id, discarded_sent, queued - queue.size());
+	return discarded_sent + queued - queue.size();
+}
+
 std::string to_string(ByteBufferAsyncProcessor::StateKind state)
 {
 	switch (state)
@@ -7,8 +7,10 @@
 #endif
 
 #include "protocol/Buffer.h"
+#include "util/mpsc_ring.h"
 #include "spdlog/spdlog.h"
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <mutex>
@@ -37,31 +39,47 @@ public:
 private:
 	using time_t = std::chrono::milliseconds;
 
-	static size_t INITIAL_CAPACITY;
+	static constexpr size_t RING_CAPACITY = 1u << 12;
+
+	static constexpr size_t SLAB_SIZE = 256;
+	static constexpr size_t MAX_POOLED_SLABS = 256;
+	static constexpr size_t MAX_POOLED_SLAB_CAPACITY = 1u << 16;
 
 	std::recursive_mutex lock;
 	std::condition_variable_any cv;
 
 	std::string id;
 
-	std::function<bool(Buffer::ByteArray const&, sequence_number_t seqn)> processor;
+	std::function<bool(Buffer::ByteArray&, sequence_number_t seqn)> processor;
 
-	StateKind state{StateKind::Initialized};
+	std::atomic<StateKind> state{StateKind::Initialized};
 	static std::shared_ptr<spdlog::logger> logger;
 
 	std::thread::id async_thread_id;
 	std::future<void> async_future;
 
-	std::vector<Buffer::ByteArray> data;
+	/**
+	 * \brief Packages put by producers, moved to [queue] by the async thread.
+	 * [data_size] counts published packages, the async thread is only woken when it goes from zero to one.
+	 */
+	util::mpsc_ring<Buffer::ByteArray> data{RING_CAPACITY};
+	std::atomic<size_t> data_size{0};
 	std::mutex queue_lock;
 	std::deque<Buffer::ByteArray> queue{};
 	std::deque<Buffer::ByteArray> pending_queue{};
 
+	/**
+	 * \brief Arrays of acknowledged packages, handed out again by [acquire_slab] so steady traffic doesn't allocate.
+	 */
+	std::mutex pool_lock;
+	std::vector<Buffer::ByteArray> free_slabs;
+
 	sequence_number_t max_sent_seqn = 0;
 	sequence_number_t current_seqn = 1;
 	sequence_number_t acknowledged_seqn = 0;
 
 	int32_t interrupt_balance = 0;
+	bool flush_requested = false;
 	bool in_processing = false;
 	std::mutex processing_lock;
 	std::condition_variable processing_cv;
@@ -69,7 +87,7 @@ private:
 public:
 	// region ctor/dtor
 
-	explicit ByteBufferAsyncProcessor(std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor);
+	explicit ByteBufferAsyncProcessor(std::string id, std::function<bool(Buffer::ByteArray&, sequence_number_t)> processor);
 
 	// endregion
 private:
@@ -77,11 +95,15 @@ private:
 
 	bool terminate0(time_t timeout, StateKind state_to_set, string_view action);
 
-	void add_data(std::vector<Buffer::ByteArray>&& new_data);
+	size_t drain_data();
+
+	void drop_acknowledged(sequence_number_t seqn);
+
+	void release_slab(Buffer::ByteArray slab);
 
 	bool reprocess();
 
-	void process();
+	void process(sequence_number_t seqn_to_drop);
 
 	void ThreadProc();
 
@@ -94,11 +116,28 @@ public:
 
 	void put(Buffer::ByteArray new_data);
 
+	/**
+	 * \brief Array to serialize the next package into, recycled from an acknowledged package when possible.
+	 * Its size is the usable capacity, pass it back to [put] trimmed to the written length.
+	 */
+	Buffer::ByteArray acquire_slab();
+
 	void pause(const std::string& reason);
 
 	void resume();
 
 	void acknowledge(int64_t seqn);
+
+	/**
+	 * \brief Whether a package put but not acknowledged yet matches [predicate]. Only while paused.
+	 */
+	bool any_unacknowledged(std::function<bool(Buffer::ByteArray const&)> const& predicate);
+
+	/**
+	 * \brief Drops the packages put but not acknowledged yet which match [predicate], returns their number.
+	 * The rest keep their order and are sent again with consecutive sequence numbers. Only while paused.
+	 */
+	size_t discard_unacknowledged(std::function<bool(Buffer::ByteArray const&)> const& predicate);
 };
 
 std::string to_string(ByteBufferAsyncProcessor::StateKind state);
@@ -0,0 +1,965 @@
+#include "EventLoopSocketWire.h"
+
+#ifdef RD_SOCKET_EVENT_LOOP
+
+#include "scheduler/TimerWheel.h"
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace rd
+{
+std::shared_ptr<spdlog::logger> EventLoopSocketWire::Base::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("eventLoopWireLog", spdlog::color_mode::automatic);
+
+std::chrono::milliseconds EventLoopSocketWire::timeout = std::chrono::milliseconds(500);
+
+constexpr int32_t EventLoopSocketWire::Base::ACK_MESSAGE_LENGTH;
+constexpr int32_t EventLoopSocketWire::Base::PING_MESSAGE_LENGTH;
+constexpr int32_t EventLoopSocketWire::Base::PACKAGE_HEADER_LENGTH;
+constexpr RdId::hash_t EventLoopSocketWire::Base::ENCODING_MESSAGE_ID;
+constexpr sequence_number_t EventLoopSocketWire::Base::ENCODING_ANNOUNCEMENT_SEQN;
+constexpr int16_t EventLoopSocketWire::Base::COMPACT_ENCODING_CONTEXT;
+constexpr size_t EventLoopSocketWire::Base::RECEIVE_CHUNK_SIZE;
+constexpr int EventLoopSocketWire::Base::MAX_IOVECS;
+constexpr size_t EventLoopSocketWire::Base::SLAB_SIZE;
+constexpr size_t EventLoopSocketWire::Base::MAX_POOLED_SLABS;
+constexpr size_t EventLoopSocketWire::Base::MAX_POOLED_SLAB_CAPACITY;
+
+namespace
+{
+constexpr uint32_t RECEIVE_EVENTS = EPOLLIN | EPOLLRDHUP;
+
+inline void disable_nagle_algorithm(int socket)
+{
+	int one = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+inline sockaddr_in loopback(uint16_t port)
+{
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	return address;
+}
+}	 // namespace
+
+EventLoopSocketWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler)
+	: WireBase(scheduler), id(std::move(id)), loop(SocketEventLoop::instance()), lifetimeDef(parentLifetime)
+{
+}
+
+EventLoopSocketWire::Base::~Base()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+Buffer::ByteArray EventLoopSocketWire::Base::acquire_slab() const
+{
+	Buffer::ByteArray slab;
+	{
+		std::lock_guard<decltype(pool_lock)> guard(pool_lock);
+		if (!free_slabs.empty())
+		{
+			slab = std::move(free_slabs.back());
+			free_slabs.pop_back();
+		}
+	}
+	slab.resize((std::max)(slab.capacity(), SLAB_SIZE));
+	return slab;
+}
+
+void EventLoopSocketWire::Base::release_slab(Buffer::ByteArray slab) const
+{
+	if (slab.capacity() > MAX_POOLED_SLAB_CAPACITY)
+	{
+		return;
+	}
+	std::lock_guard<decltype(pool_lock)> guard(pool_lock);
+	if (free_slabs.size() < MAX_POOLED_SLABS)
+	{
+		free_slabs.emplace_back(std::move(slab));
+	}
+}
+
+void EventLoopSocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
+
+	Buffer buffer{acquire_slab(), PACKAGE_HEADER_LENGTH};	 // package header is patched below
+	buffer.write_fixed_integral<int32_t>(0);				 // placeholder for length
+	rd_id.write(buffer);
+	const size_t context_position = buffer.get_position();
+	buffer.write_fixed_integral<int16_t>(0);	// placeholder for context
+	if (compactEncoding && counterpart_reads_compact)
+	{
+		buffer.set_encoding(Buffer::Encoding::Compact);
+	}
+	writer(buffer);	   // write rest, the writer may fall back to the fixed encoding
+
+	const int32_t len = static_cast<int32_t>(buffer.get_position());
+	buffer.set_position(0);
+	buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH);
+	buffer.set_position(PACKAGE_HEADER_LENGTH);
+	buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH - 4);
+	if (buffer.get_encoding() == Buffer::Encoding::Compact)
+	{
+		buffer.set_position(context_position);
+		buffer.write_fixed_integral<int16_t>(COMPACT_ENCODING_CONTEXT);
+	}
+	buffer.set_position(len);
+	WireStatistics* statistics = message_broker.get_statistics();
+	if (statistics != nullptr)
+	{
+		statistics->on_sent(rd_id, static_cast<size_t>(len - PACKAGE_HEADER_LENGTH - 4 - 8));	 // without length and id
+	}
+	Buffer::ByteArray pkg = std::move(buffer).getRealArray();
+
+	std::lock_guard<decltype(lock)> guard(lock);
+	const sequence_number_t seqn = first_pending_seqn + static_cast<sequence_number_t>(pending.size());
+	std::memcpy(pkg.data() + sizeof(int32_t), &seqn, sizeof(seqn));
+	pending.push_back(std::move(pkg));
+	if (!watching_writable && !holding_pending)
+	{
+		// otherwise the socket is full and the loop writes it once it isn't
+		flush_output();
+	}
+}
+
+void EventLoopSocketWire::Base::flush_output() const
+{
+	while (fd != -1)
+	{
+		std::array<iovec, MAX_IOVECS> iov{};
+		int count = 0;
+		size_t total = 0;
+
+		const bool with_control = write_offset == 0 && control_offset < control.size();
+		if (with_control)
+		{
+			iov[count++] = {control.data() + control_offset, control.size() - control_offset};
+			total += control.size() - control_offset;
+		}
+		size_t offset = write_offset;
+		for (auto index = static_cast<size_t>(next_write_seqn - first_pending_seqn);
+			 !holding_pending && count < MAX_IOVECS && index < pending.size(); ++index)
+		{
+			iov[count++] = {pending[index].data() + offset, pending[index].size() - offset};
+			total += pending[index].size() - offset;
+			offset = 0;
+		}
+
+		if (count == 0)
+		{
+			control.clear();
+			control_offset = 0;
+			if (watching_writable)
+			{
+				watching_writable = false;
+				loop.modify(fd, RECEIVE_EVENTS);
+			}
+			return;
+		}
+
+		msghdr message{};
+		message.msg_iov = iov.data();
+		message.msg_iovlen = static_cast<size_t>(count);
+		const ssize_t written = sendmsg(fd, &message, MSG_NOSIGNAL);
+		if (written == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				// the loop gets an error event for the socket and disconnects
+				logger->debug("{}: failed to send over the network, reason: {}", id, std::strerror(errno));
+				return;
+			}
+		}
+
+		auto rest = static_cast<size_t>((std::max)(written, ssize_t{0}));
+		if (with_control)
+		{
+			const size_t n = (std::min)(rest, control.size() - control_offset);
+			control_offset += n;
+			rest -= n;
+		}
+		while (rest > 0)
+		{
+			auto const& pkg = pending[static_cast<size_t>(next_write_seqn - first_pending_seqn)];
+			const size_t n = (std::min)(rest, pkg.size() - write_offset);
+			write_offset += n;
+			rest -= n;
+			if (write_offset == pkg.size())
+			{
+				++next_write_seqn;
+				write_offset = 0;
+			}
+		}
+
+		if (static_cast<size_t>((std::max)(written, ssize_t{0})) < total)
+		{
+			// socket is full
+			if (!watching_writable)
+			{
+				watching_writable = true;
+				loop.modify(fd, RECEIVE_EVENTS | EPOLLOUT);
+			}
+			return;
+		}
+	}
+}
+
+void EventLoopSocketWire::Base::write_control(int32_t len, void const* body) const
+{
+	const size_t at = control.size();
+	control.resize(at + PACKAGE_HEADER_LENGTH);
+	std::memcpy(control.data() + at, &len, sizeof(len));
+	std::memcpy(control.data() + at + sizeof(len), body, PACKAGE_HEADER_LENGTH - sizeof(len));
+}
+
+void EventLoopSocketWire::Base::write_encoding_announcement() const
+{
+	Buffer buffer{PACKAGE_HEADER_LENGTH + 16};
+	buffer.write_fixed_integral<int32_t>(0);	// placeholder for length
+	buffer.write_fixed_integral<sequence_number_t>(ENCODING_ANNOUNCEMENT_SEQN);
+	buffer.write_fixed_integral<int32_t>(0);	// placeholder for message length
+	RdId{ENCODING_MESSAGE_ID}.write(buffer);
+	buffer.write_fixed_integral<int16_t>(0);	// context
+	buffer.write_integral<uint8_t>(compactEncoding ? 1u << static_cast<uint8_t>(Buffer::Encoding::Compact) : 0u);
+	const int32_t len = static_cast<int32_t>(buffer.get_position());
+	buffer.set_position(0);
+	buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH);
+	buffer.set_position(PACKAGE_HEADER_LENGTH);
+	buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH - 4);
+
+	control.insert(control.end(), buffer.data(), buffer.data() + len);
+}
+
+void EventLoopSocketWire::Base::on_counterpart_encodings(uint8_t encodings)
+{
+	counterpart_encodings_known = true;
+	counterpart_reads_compact = (encodings & (1u << static_cast<uint8_t>(Buffer::Encoding::Compact))) != 0;
+	logger->debug("{}: counterpart reads encodings {}", id, encodings);
+
+	std::lock_guard<decltype(lock)> guard(lock);
+	if (!holding_pending)
+	{
+		return;
+	}
+	holding_pending = false;
+	if (!counterpart_reads_compact)
+	{
+		// neither rd-net nor an older rd-cpp look at the context, they would misread these messages
+		const size_t before = pending.size();
+		pending.erase(std::remove_if(pending.begin(), pending.end(), is_compact_package), pending.end());
+		// nothing has been written to this connection yet, the rest goes out with consecutive seqns
+		for (size_t i = 0; i < pending.size(); ++i)
+		{
+			const sequence_number_t seqn = first_pending_seqn + static_cast<sequence_number_t>(i);
+			std::memcpy(pending[i].data() + sizeof(int32_t), &seqn, sizeof(seqn));
+		}
+		logger->warn("{}: counterpart doesn't read the compact encoding, dropped {} packages written for the previous one",
+			id, before - pending.size());
+	}
+	if (!watching_writable)
+	{
+		flush_output();
+	}
+}
+
+bool EventLoopSocketWire::Base::is_compact_package(Buffer::ByteArray const& pkg)
+{
+	// package header, message length and id come before the context
+	constexpr size_t context_position = PACKAGE_HEADER_LENGTH + sizeof(int32_t) + sizeof(RdId::hash_t);
+	int16_t context = 0;
+	if (pkg.size() >= context_position + sizeof(context))
+	{
+		std::memcpy(&context, pkg.data() + context_position, sizeof(context));
+	}
+	return (context & COMPACT_ENCODING_CONTEXT) != 0;
+}
+
+bool EventLoopSocketWire::Base::attach(int socket)
+{
+	std::unique_ptr<LifetimeDefinition> definition;
+	try
+	{
+		definition = std::make_unique<LifetimeDefinition>(lifetimeDef.lifetime);
+	}
+	catch (std::invalid_argument const&)
+	{
+		close(socket);	  // the wire is being terminated
+		return false;
+	}
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (terminated)
+		{
+			close(socket);
+			return false;
+		}
+		fd = socket;
+		watching_writable = false;
+		// everything which isn't acknowledged might have been lost with the previous connection
+		next_write_seqn = first_pending_seqn;
+		write_offset = 0;
+		control.clear();
+		control_offset = 0;
+		// the counterpart may be another process now, it has to tell its encodings again
+		write_encoding_announcement();
+		holding_pending = std::any_of(pending.begin(), pending.end(), is_compact_package);
+		counterpart_reads_compact = false;
+		counterpart_encodings_known = false;
+		loop.add(socket, RECEIVE_EVENTS, [this](uint32_t events) { on_socket_event(events); });
+	}
+
+	// leftovers of the previous connection
+	input_lo = input_hi = input_needed = 0;
+	partial_message.clear();
+	sent_ack_seqn = 0;
+	unacked_packages = 0;
+
+	connection_definition = std::move(definition);
+	TimerWheel::instance().schedule(connection_definition->lifetime, heartBeatInterval, heartBeatInterval, [this] { ping(); });
+
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		flush_output();
+	}
+
+	connected.set(true);
+	return true;
+}
+
+void EventLoopSocketWire::Base::detach()
+{
+	int socket;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		socket = fd;
+		fd = -1;
+		watching_writable = false;
+	}
+	if (socket == -1)
+	{
+		return;
+	}
+	loop.remove(socket);
+	close(socket);
+	logger->debug("{}: disconnected", id);
+
+	connected.set(false);
+	// stops the heartbeat, waits for a ping in flight
+	if (connection_definition != nullptr)
+	{
+		connection_definition->terminate();
+		connection_definition.reset();
+	}
+	on_detached();
+}
+
+void EventLoopSocketWire::Base::close_connection()
+{
+	int socket;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		terminated = true;
+		socket = fd;
+		fd = -1;
+		watching_writable = false;
+	}
+	if (socket != -1)
+	{
+		loop.remove(socket);
+		close(socket);
+		connected.set(false);
+	}
+}
+
+void EventLoopSocketWire::Base::on_socket_event(uint32_t events)
+{
+	if ((events & EPOLLOUT) != 0)
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		flush_output();
+	}
+	if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0 && !receive())
+	{
+		detach();
+	}
+}
+
+bool EventLoopSocketWire::Base::receive()
+{
+	int socket;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		socket = fd;
+	}
+	if (socket == -1)
+	{
+		return true;	// closed by termination
+	}
+
+	while (true)
+	{
+		if (input_lo == input_hi)
+		{
+			input_lo = input_hi = 0;
+			if (input.size() > RECEIVE_CHUNK_SIZE * 4)
+			{
+				// don't keep the memory of a huge message
+				std::vector<Buffer::word_t>().swap(input);
+			}
+		}
+		const size_t required = (std::max)(RECEIVE_CHUNK_SIZE, input_needed);
+		if (input.size() - input_lo < required || input_hi == input.size())
+		{
+			// move the unparsed rest to the front
+			std::memmove(input.data(), input.data() + input_lo, input_hi - input_lo);
+			input_hi -= input_lo;
+			input_lo = 0;
+			if (input.size() < required)
+			{
+				input.resize(required);
+			}
+			else if (input_hi == input.size())
+			{
+				input.resize(input.size() * 2);
+			}
+		}
+
+		const size_t space = input.size() - input_hi;
+		const ssize_t read = recv(socket, input.data() + input_hi, space, 0);
+		if (read == 0)
+		{
+			logger->debug("{}: connection was gracefully shutdown", id);
+			return false;
+		}
+		if (read == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			logger->debug("{}: error has occurred while receiving, reason: {}", id, std::strerror(errno));
+			return false;
+		}
+		input_hi += static_cast<size_t>(read);
+		if (!parse_input())
+		{
+			return false;
+		}
+		if (static_cast<size_t>(read) < space)
+		{
+			break;	  // drained, level-triggered epoll reports the socket again if more has arrived
+		}
+	}
+	// everything received so far is processed, acknowledge it before waiting
+	flush_ack();
+	return true;
+}
+
+bool EventLoopSocketWire::Base::parse_input()
+{
+	while (true)
+	{
+		input_needed = 0;
+		const size_t available = input_hi - input_lo;
+		Buffer::word_t const* data = input.data() + input_lo;
+		if (available < sizeof(int32_t))
+		{
+			return true;
+		}
+		int32_t len;
+		std::memcpy(&len, data, sizeof(len));
+		if (available < PACKAGE_HEADER_LENGTH)
+		{
+			return true;
+		}
+		if (len == PING_MESSAGE_LENGTH)
+		{
+			int32_t received_timestamp;
+			int32_t received_counterpart_timestamp;
+			std::memcpy(&received_timestamp, data + sizeof(len), sizeof(received_timestamp));
+			std::memcpy(&received_counterpart_timestamp, data + sizeof(len) + sizeof(received_timestamp),
+				sizeof(received_counterpart_timestamp));
+			input_lo += PACKAGE_HEADER_LENGTH;
+			if (!counterpart_encodings_known)
+			{
+				on_counterpart_encodings(0);
+			}
+			receive_ping(received_timestamp, received_counterpart_timestamp);
+			continue;
+		}
+		sequence_number_t seqn;
+		std::memcpy(&seqn, data + sizeof(len), sizeof(seqn));
+		if (len == ACK_MESSAGE_LENGTH)
+		{
+			input_lo += PACKAGE_HEADER_LENGTH;
+			if (!counterpart_encodings_known)
+			{
+				// an acknowledge of the announcement comes from a counterpart which skipped it
+				on_counterpart_encodings(0);
+			}
+			if (seqn != ENCODING_ANNOUNCEMENT_SEQN)
+			{
+				acknowledge(seqn);
+			}
+			continue;
+		}
+		if (len < 0)
+		{
+			logger->error("{}: invalid package length: {}", id, len);
+			return false;
+		}
+		const size_t package_size = PACKAGE_HEADER_LENGTH + static_cast<size_t>(len);
+		if (available < package_size)
+		{
+			input_needed = package_size;
+			return true;
+		}
+		input_lo += package_size;
+
+		if (seqn == ENCODING_ANNOUNCEMENT_SEQN)
+		{
+			if (!read_encoding_announcement(data + PACKAGE_HEADER_LENGTH, len))
+			{
+				return false;
+			}
+			continue;
+		}
+		if (!counterpart_encodings_known)
+		{
+			on_counterpart_encodings(0);
+		}
+
+		if (seqn <= max_received_seqn && seqn != 1)
+		{
+			// resent after a reconnect, already dispatched
+			queue_ack(seqn);
+			continue;
+		}
+		max_received_seqn = seqn;
+		logger->info("{}: was received package, bytes={}, seqn={}", id, len, seqn);
+
+		if (!receive_package(data + PACKAGE_HEADER_LENGTH, static_cast<size_t>(len)))
+		{
+			return false;
+		}
+		queue_ack(seqn);
+	}
+}
+
+bool EventLoopSocketWire::Base::read_encoding_announcement(Buffer::word_t const* data, int32_t len)
+{
+	// message length, id and context come first, anything after the encodings is left to later versions
+	constexpr int32_t encodings_position = sizeof(int32_t) + sizeof(RdId::hash_t) + sizeof(int16_t);
+	RdId::hash_t announced_id = 0;
+	if (len > encodings_position)
+	{
+		std::memcpy(&announced_id, data + sizeof(int32_t), sizeof(announced_id));
+	}
+	if (announced_id != ENCODING_MESSAGE_ID)
+	{
+		logger->error("{}: invalid encoding announcement, len={}, id={}", id, len, announced_id);
+		return false;
+	}
+	if (!counterpart_encodings_known)
+	{
+		on_counterpart_encodings(data[encodings_position]);
+	}
+	return true;
+}
+
+bool EventLoopSocketWire::Base::receive_package(Buffer::word_t const* data, size_t size)
+{
+	if (partial_message.empty())
+	{
+		// usually a package holds whole messages, they are dispatched right out of the input
+		const int64_t used = dispatch_messages(data, size);
+		if (used < 0)
+		{
+			return false;
+		}
+		partial_message.assign(data + used, data + size);
+		return true;
+	}
+	partial_message.insert(partial_message.end(), data, data + size);
+	const int64_t used = dispatch_messages(partial_message.data(), partial_message.size());
+	if (used < 0)
+	{
+		return false;
+	}
+	partial_message.erase(partial_message.begin(), partial_message.begin() + used);
+	return true;
+}
+
+int64_t EventLoopSocketWire::Base::dispatch_messages(Buffer::word_t const* data, size_t size)
+{
+	size_t position = 0;
+	while (size - position >= sizeof(int32_t))
+	{
+		int32_t sz;
+		std::memcpy(&sz, data + position, sizeof(sz));
+		if (sz < static_cast<int32_t>(sizeof(RdId::hash_t)))
+		{
+			logger->error("{}: invalid message size: {}", id, sz);
+			return -1;
+		}
+		if (size - position - sizeof(sz) < static_cast<size_t>(sz))
+		{
+			break;
+		}
+		if (!dispatch_message(data + position + sizeof(sz), sz))
+		{
+			return -1;
+		}
+		position += sizeof(sz) + static_cast<size_t>(sz);
+	}
+	return static_cast<int64_t>(position);
+}
+
+bool EventLoopSocketWire::Base::dispatch_message(Buffer::word_t const* data, int32_t size)
+{
+	RdId::hash_t id_;
+	std::memcpy(&id_, data, sizeof(id_));
+	if (id_ == -1)
+	{
+		logger->error("id == -1");
+		return false;
+	}
+	logger->trace("{}: message info: sz={}, id={}", id, size, id_);
+	const int32_t len = size - static_cast<int32_t>(sizeof(id_));
+
+	// the only copy of the message, it's owned by the scheduler of its entity until handled
+	Buffer message{static_cast<size_t>(len)};
+	std::memcpy(message.data(), data + sizeof(id_), static_cast<size_t>(len));
+
+	const int16_t context = message.read_fixed_integral<int16_t>();
+	message.rewind();	 // context is skipped by the broker
+	if ((context & COMPACT_ENCODING_CONTEXT) != 0)
+	{
+		message.set_encoding(Buffer::Encoding::Compact);
+	}
+
+	message_broker.dispatch(RdId{id_}, std::move(message));
+	return true;
+}
+
+bool EventLoopSocketWire::Base::connection_established(int32_t timestamp, int32_t acknowledged_timestamp)
+{
+	return timestamp - acknowledged_timestamp <= MaximumHeartbeatDelay;
+}
+
+void EventLoopSocketWire::Base::ping() const
+{
+	bool alive;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (fd == -1)
+		{
+			return;
+		}
+		alive = connection_established(current_timestamp, counterpart_acknowledge_timestamp);
+		const std::array<int32_t, 2> body{current_timestamp, counterpart_timestamp};
+		write_control(PING_MESSAGE_LENGTH, body.data());
+		++current_timestamp;
+		if (!watching_writable)
+		{
+			flush_output();
+		}
+	}
+	// properties are changed outside of the lock, their listeners may send
+	if (!alive)
+	{
+		if (heartbeatAlive.get())
+		{	 // only on change
+			logger->trace("Disconnect detected while sending PING {}", id);
+		}
+		heartbeatAlive.set(false);
+	}
+}
+
+void EventLoopSocketWire::Base::receive_ping(int32_t timestamp, int32_t counterpart_ack_timestamp)
+{
+	bool alive;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		counterpart_timestamp = timestamp;
+		counterpart_acknowledge_timestamp = counterpart_ack_timestamp;
+		alive = connection_established(current_timestamp, counterpart_acknowledge_timestamp);
+	}
+	if (alive)
+	{
+		if (!heartbeatAlive.get())
+		{	 // only on change
+			logger->trace("Connection is alive after receiving PING {}", id);
+		}
+		heartbeatAlive.set(true);
+	}
+}
+
+void EventLoopSocketWire::Base::acknowledge(sequence_number_t seqn)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	// a package can only be acknowledged once it has been written completely
+	while (first_pending_seqn <= seqn && first_pending_seqn < next_write_seqn)
+	{
+		release_slab(std::move(pending.front()));
+		pending.pop_front();
+		++first_pending_seqn;
+	}
+}
+
+void EventLoopSocketWire::Base::queue_ack(sequence_number_t seqn)
+{
+	++packages_received;
+
+	if (seqn == 1)
+	{
+		// counterpart has restarted its sequence
+		pending_ack_seqn = seqn;
+		sent_ack_seqn = 0;
+	}
+	else
+	{
+		pending_ack_seqn = (std::max)(pending_ack_seqn, seqn);
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (unacked_packages++ == 0)
+	{
+		first_unacked_time = now;
+	}
+	if (unacked_packages >= ackThreshold || now - first_unacked_time >= ackDelay)
+	{
+		flush_ack();
+	}
+}
+
+void EventLoopSocketWire::Base::flush_ack()
+{
+	if (unacked_packages == 0)
+	{
+		return;
+	}
+	unacked_packages = 0;
+	if (pending_ack_seqn == sent_ack_seqn)
+	{
+		// only duplicates since the last acknowledge
+		return;
+	}
+	sent_ack_seqn = pending_ack_seqn;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (fd == -1)
+		{
+			return;
+		}
+		write_control(ACK_MESSAGE_LENGTH, &sent_ack_seqn);
+		if (!watching_writable)
+		{
+			flush_output();
+		}
+	}
+	++acks_sent;
+}
+
+int64_t EventLoopSocketWire::Base::get_packages_received() const
+{
+	return packages_received.load();
+}
+
+int64_t EventLoopSocketWire::Base::get_acks_sent() const
+{
+	return acks_sent.load();
+}
+
+EventLoopSocketWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
+	: Base(id, parentLifetime, scheduler), port(port)
+{
+	lifetimeDef.lifetime->add_action([this] {
+		logger->info("{}: starts terminating lifetime", this->id);
+		int socket;
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			terminated = true;
+			socket = connecting_fd;
+			connecting_fd = -1;
+		}
+		if (socket != -1)
+		{
+			loop.remove(socket);
+			close(socket);
+		}
+		close_connection();
+		logger->info("{}: termination finished", this->id);
+	});
+
+	connect();
+}
+
+EventLoopSocketWire::Client::~Client()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+void EventLoopSocketWire::Client::connect()
+{
+	const int socket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (socket == -1)
+	{
+		logger->error("{}: failed to init socket, reason: {}", id, std::strerror(errno));
+		reconnect_later();
+		return;
+	}
+	disable_nagle_algorithm(socket);
+
+	logger->info("{}: connecting 127.0.0.1: {}", id, port);
+	const sockaddr_in address = loopback(port);
+	if (::connect(socket, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == -1 && errno != EINPROGRESS)
+	{
+		logger->debug("{}: failed to connect, reason: {}", id, std::strerror(errno));
+		close(socket);
+		reconnect_later();
+		return;
+	}
+
+	std::lock_guard<decltype(lock)> guard(lock);
+	if (terminated)
+	{
+		close(socket);
+		return;
+	}
+	connecting_fd = socket;
+	loop.add(socket, EPOLLOUT, [this, socket](uint32_t events) { on_connect_ready(socket, events); });
+}
+
+void EventLoopSocketWire::Client::on_connect_ready(int socket, uint32_t events)
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (connecting_fd != socket)
+		{
+			return;	   // closed by termination
+		}
+		connecting_fd = -1;
+	}
+	loop.remove(socket);
+
+	int error = 0;
+	socklen_t length = sizeof(error);
+	getsockopt(socket, SOL_SOCKET, SO_ERROR, &error, &length);
+	if (error != 0 || (events & (EPOLLERR | EPOLLHUP)) != 0)
+	{
+		logger->debug("{}: failed to connect, reason: {}", id, std::strerror(error));
+		close(socket);
+		reconnect_later();
+		return;
+	}
+	attach(socket);
+}
+
+void EventLoopSocketWire::Client::reconnect_later()
+{
+	TimerWheel::instance().schedule(lifetimeDef.lifetime, timeout, std::chrono::milliseconds(0), [this] { connect(); });
+}
+
+void EventLoopSocketWire::Client::on_detached()
+{
+	connect();
+}
+
+EventLoopSocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
+	: Base(id, parentLifetime, scheduler)
+{
+	listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	RD_ASSERT_MSG(listen_fd != -1, fmt::format("{}: failed to initialize socket, reason: {}", this->id, std::strerror(errno)))
+	int one = 1;
+	setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	sockaddr_in address = loopback(port);
+	RD_ASSERT_MSG(bind(listen_fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0 &&
+					  listen(listen_fd, SOMAXCONN) == 0,
+		fmt::format("{}: failed to listen socket on port: {}, reason: {}", this->id, std::to_string(port), std::strerror(errno)))
+
+	socklen_t length = sizeof(address);
+	getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+	this->port = ntohs(address.sin_port);
+	RD_ASSERT_MSG(this->port != 0, fmt::format("{}: port wasn't chosen", this->id))
+
+	logger->info("{}: listening 127.0.0.1/{}", this->id, this->port);
+
+	lifetimeDef.lifetime->add_action([this] {
+		logger->info("{}: start terminating lifetime", this->id);
+		loop.remove(listen_fd);
+		close_connection();
+		close(listen_fd);
+		logger->info("{}: termination finished", this->id);
+	});
+
+	loop.add(listen_fd, EPOLLIN, [this](uint32_t) { on_accept_ready(); });
+}
+
+EventLoopSocketWire::Server::~Server()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+void EventLoopSocketWire::Server::on_accept_ready()
+{
+	const int socket = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (socket == -1)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			logger->warn("{}: accepting failed, reason: {}", id, std::strerror(errno));
+		}
+		return;
+	}
+	disable_nagle_algorithm(socket);
+	logger->info("{}: accepted passive socket", id);
+
+	// one connection at a time, the next one is accepted when it's gone
+	loop.modify(listen_fd, 0);
+	attach(socket);
+}
+
+void EventLoopSocketWire::Server::on_detached()
+{
+	loop.modify(listen_fd, EPOLLIN);
+}
+}	 // namespace rd
+
+#endif	  // RD_SOCKET_EVENT_LOOP
@@ -0,0 +1,307 @@
+#ifndef RD_CPP_EVENTLOOPSOCKETWIRE_H
+#define RD_CPP_EVENTLOOPSOCKETWIRE_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "SocketEventLoop.h"
+
+#ifdef RD_SOCKET_EVENT_LOOP
+
+#include "scheduler/base/IScheduler.h"
+#include "base/WireBase.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+using sequence_number_t = int64_t;
+
+/**
+ * \brief Wire with the protocol of [SocketWire] which doesn't own any thread. Sockets are non-blocking and are served by
+ * [SocketEventLoop::instance], heartbeats by [TimerWheel::instance], so any number of wires costs these two threads.
+ * Messages are written to the socket by the sending thread as long as it accepts them, the loop writes the rest.
+ */
+class RD_FRAMEWORK_API EventLoopSocketWire
+{
+	static std::chrono::milliseconds timeout;
+
+public:
+	class RD_FRAMEWORK_API Base : public WireBase
+	{
+	protected:
+		static std::shared_ptr<spdlog::logger> logger;
+
+		static constexpr int32_t ACK_MESSAGE_LENGTH = -1;
+		static constexpr int32_t PING_MESSAGE_LENGTH = -2;
+		static constexpr int32_t PACKAGE_HEADER_LENGTH = sizeof(ACK_MESSAGE_LENGTH) + sizeof(sequence_number_t);
+		/**
+		 * \brief Same out of band announcement of the encodings as [SocketWire::Base::ENCODING_MESSAGE_ID].
+		 */
+		static constexpr RdId::hash_t ENCODING_MESSAGE_ID = -2;
+		static constexpr sequence_number_t ENCODING_ANNOUNCEMENT_SEQN = 0;
+		static constexpr int16_t COMPACT_ENCODING_CONTEXT = 0x4000;
+
+		static constexpr size_t RECEIVE_CHUNK_SIZE = 1u << 14;
+		static constexpr int MAX_IOVECS = 64;
+
+		static constexpr size_t SLAB_SIZE = 256;
+		static constexpr size_t MAX_POOLED_SLABS = 256;
+		static constexpr size_t MAX_POOLED_SLAB_CAPACITY = 1u << 16;
+
+		std::string id;
+
+		SocketEventLoop& loop;
+
+		// region guarded by lock
+
+		mutable std::mutex lock;
+
+		/**
+		 * \brief Connected socket, -1 while there is none. Only the loop's thread changes it.
+		 */
+		int fd = -1;
+
+		bool terminated = false;
+
+		mutable bool watching_writable = false;
+
+		/**
+		 * \brief Packages which aren't acknowledged yet, headers included. The front one has [first_pending_seqn],
+		 * they are written from [next_write_seqn] on and all written again after a reconnect.
+		 */
+		mutable std::deque<Buffer::ByteArray> pending;
+		mutable sequence_number_t first_pending_seqn = 1;
+		mutable sequence_number_t next_write_seqn = 1;
+		mutable size_t write_offset = 0;
+
+		/**
+		 * \brief Set after a reconnect while [pending] holds packages written in the compact encoding for the previous
+		 * counterpart: none of [pending] is written until the new one has told what it reads.
+		 */
+		mutable bool holding_pending = false;
+
+		/**
+		 * \brief Acknowledges and pings, written between packages.
+		 */
+		mutable Buffer::ByteArray control;
+		mutable size_t control_offset = 0;
+
+
+		mutable int32_t current_timestamp = 0;
+		mutable int32_t counterpart_timestamp = 0;
+		mutable int32_t counterpart_acknowledge_timestamp = 0;
+
+		// endregion
+
+		// region loop's thread only
+
+		std::vector<Buffer::word_t> input;
+		size_t input_lo = 0;
+		size_t input_hi = 0;
+
+		/**
+		 * \brief Bytes the package at [input_lo] needs to be received completely.
+		 */
+		size_t input_needed = 0;
+
+		/**
+		 * \brief Start of a message whose rest is in the following packages.
+		 */
+		std::vector<Buffer::word_t> partial_message;
+
+		sequence_number_t max_received_seqn = 0;
+		sequence_number_t pending_ack_seqn = 0;
+		sequence_number_t sent_ack_seqn = 0;
+		int32_t unacked_packages = 0;
+		std::chrono::steady_clock::time_point first_unacked_time{};
+
+		std::unique_ptr<LifetimeDefinition> connection_definition;
+
+		/**
+		 * \brief Whether the first package of the counterpart has told what it reads.
+		 */
+		bool counterpart_encodings_known = false;
+
+		// endregion
+
+		mutable std::mutex pool_lock;
+		mutable std::vector<Buffer::ByteArray> free_slabs;
+
+		mutable std::atomic<bool> counterpart_reads_compact{false};
+
+		std::atomic<int64_t> packages_received{0};
+		mutable std::atomic<int64_t> acks_sent{0};
+
+		/**
+		 * \brief Writes as much of the queued output as the socket takes, watches it for writability if some is left.
+		 * Must be called under [lock].
+		 */
+		void flush_output() const;
+
+		/**
+		 * \brief Queues an acknowledge or a ping, [body] is the rest of its header. Must be called under [lock].
+		 */
+		void write_control(int32_t len, void const* body) const;
+
+		Buffer::ByteArray acquire_slab() const;
+
+		void release_slab(Buffer::ByteArray slab) const;
+
+		/**
+		 * \brief Makes [socket] the connection and starts using it, returns false if the wire is terminated.
+		 * Called on the loop's thread.
+		 */
+		bool attach(int socket);
+
+		/**
+		 * \brief Closes the connection if there is one, called on the loop's thread.
+		 */
+		void detach();
+
+		/**
+		 * \brief Closes the connection from any thread once the wire is terminated.
+		 */
+		void close_connection();
+
+		virtual void on_detached() = 0;
+
+		void on_socket_event(uint32_t events);
+
+		bool receive();
+
+		bool parse_input();
+
+		bool read_encoding_announcement(Buffer::word_t const* data, int32_t len);
+
+		bool receive_package(Buffer::word_t const* data, size_t size);
+
+		/**
+		 * \brief Dispatches the complete messages at the start of [data], returns the number of bytes they took or -1.
+		 */
+		int64_t dispatch_messages(Buffer::word_t const* data, size_t size);
+
+		bool dispatch_message(Buffer::word_t const* data, int32_t size);
+
+		void receive_ping(int32_t timestamp, int32_t counterpart_ack_timestamp);
+
+		void acknowledge(sequence_number_t seqn);
+
+		void queue_ack(sequence_number_t seqn);
+
+		void flush_ack();
+
+		/**
+		 * \brief Queues the announcement of the encodings this side reads ahead of everything else. Must be called under [lock].
+		 */
+		void write_encoding_announcement() const;
+
+		/**
+		 * \brief Called for the first package of the counterpart: with its announcement or with no encodings if it
+		 * has sent anything else. Releases [pending], dropping the compact packages if the counterpart can't read them.
+		 */
+		void on_counterpart_encodings(uint8_t encodings);
+
+		static bool is_compact_package(Buffer::ByteArray const& pkg);
+
+	public:
+		static constexpr int32_t MaximumHeartbeatDelay = 3;
+		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
+
+		/**
+		 * \brief Same acknowledging policy as [SocketWire::Base::ackThreshold] and [SocketWire::Base::ackDelay].
+		 */
+		int32_t ackThreshold = 32;
+		std::chrono::milliseconds ackDelay = std::chrono::milliseconds(10);
+
+		bool compactEncoding = true;
+
+		// region ctor/dtor
+
+		Base(std::string id, Lifetime lifetime, IScheduler* scheduler);
+
+		virtual ~Base() override;
+
+		// endregion
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+
+		static bool connection_established(int32_t timestamp, int32_t acknowledged_timestamp);
+
+		void ping() const;
+
+		int64_t get_packages_received() const;
+
+		int64_t get_acks_sent() const;
+
+	protected:
+		LifetimeDefinition lifetimeDef;
+	};
+
+	class RD_FRAMEWORK_API Client : public Base
+	{
+		/**
+		 * \brief Socket which is being connected, guarded by [lock].
+		 */
+		int connecting_fd = -1;
+
+		void connect();
+
+		void on_connect_ready(int socket, uint32_t events);
+
+		void reconnect_later();
+
+		void on_detached() override;
+
+	public:
+		uint16_t port = 0;
+
+		// region ctor/dtor
+
+		Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ClientSocket");
+
+		virtual ~Client() override;
+
+		// endregion
+	};
+
+	class RD_FRAMEWORK_API Server : public Base
+	{
+		int listen_fd = -1;
+
+		void on_accept_ready();
+
+		void on_detached() override;
+
+	public:
+		uint16_t port = 0;
+
+		// region ctor/dtor
+
+		Server(Lifetime lifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ServerSocket");
+
+		virtual ~Server() override;
+
+		// endregion
+	};
+};
+}	 // namespace rd
+
+#endif	  // RD_SOCKET_EVENT_LOOP
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_EVENTLOOPSOCKETWIRE_H
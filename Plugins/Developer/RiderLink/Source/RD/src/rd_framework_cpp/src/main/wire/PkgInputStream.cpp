@@ -8,43 +8,27 @@ namespace rd
 {
 void PkgInputStream::rewind()
 {
-	buffer.rewind();
-}
-
-void PkgInputStream::require_available(int size)
-{
-	buffer.require_available(size);
-}
-
-size_t PkgInputStream::get_position() const
-{
-	return buffer.get_position();
-}
-
-Buffer::word_t* PkgInputStream::data()
-{
-	return buffer.data();
-}
-
-Buffer& PkgInputStream::get_buffer()
-{
-	return buffer;
+	available = 0;
 }
 
 int32_t PkgInputStream::try_read(Buffer::word_t* res, size_t size)
 {
-	if (memory == -1 || buffer.get_position() == memory)
+	if (available <= 0)
 	{
-		memory = request_data();
-		if (memory == -1)
+		available = request_data();
+		if (available == -1)
 		{
+			available = 0;
 			return -1;
 		}
 	}
-	const int32_t n = static_cast<int32_t>((std::min)(size, memory - buffer.get_position()));
-	Buffer::word_t* start = buffer.current_pointer();
-	std::copy(start, start + n, res);
-	buffer.set_position(buffer.get_position() + n);
+	const int32_t n = static_cast<int32_t>((std::min)(size, static_cast<size_t>(available)));
+	if (!receive_data(res, n))
+	{
+		available = 0;
+		return -1;
+	}
+	available -= n;
 	return n;
 }
 
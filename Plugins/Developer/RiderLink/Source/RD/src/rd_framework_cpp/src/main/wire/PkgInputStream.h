@@ -12,31 +12,35 @@
 
 namespace rd
 {
+/**
+ * \brief Reads messages spanning one or more packages straight out of the wire, without buffering whole packages.
+ */
 class RD_FRAMEWORK_API PkgInputStream
 {
 private:
-	Buffer buffer;
-
+	/**
+	 * \brief Starts the next package and returns its length, -1 if the connection is gone.
+	 */
 	std::function<int32_t()> request_data;
 
-	size_t memory = 0;
+	/**
+	 * \brief Reads bytes of the current package.
+	 */
+	std::function<bool(Buffer::word_t*, size_t)> receive_data;
+
+	int32_t available = 0;
 
 public:
-	template <typename F>
-	explicit PkgInputStream(F&& f) : request_data(std::forward<F>(f))
+	template <typename F, typename R>
+	PkgInputStream(F&& f, R&& r) : request_data(std::forward<F>(f)), receive_data(std::forward<R>(r))
 	{
 	}
 
+	/**
+	 * \brief Forgets the rest of the current package, e.g. after a reconnect.
+	 */
 	void rewind();
 
-	void require_available(int size);
-
-	size_t get_position() const;
-
-	Buffer::word_t* data();
-
-	Buffer& get_buffer();
-
 	int32_t try_read(Buffer::word_t* res, size_t size);
 
 	bool read(Buffer::word_t* res, size_t size);
@@ -0,0 +1,664 @@
+#include "SharedMemoryWire.h"
+
+#ifdef RD_SHARED_MEMORY_WIRE
+
+#include "util/thread_util.h"
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+namespace rd
+{
+std::shared_ptr<spdlog::logger> SharedMemoryWire::Base::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("sharedMemoryWireLog", spdlog::color_mode::automatic);
+
+std::chrono::milliseconds SharedMemoryWire::timeout = std::chrono::milliseconds(500);
+
+constexpr size_t SharedMemoryWire::Base::RING_CAPACITY;
+constexpr size_t SharedMemoryWire::Base::MAX_CHUNK_SIZE;
+constexpr uint32_t SharedMemoryWire::Base::FIRST_CHUNK;
+constexpr uint32_t SharedMemoryWire::Base::LAST_CHUNK;
+constexpr int16_t SharedMemoryWire::Base::COMPACT_ENCODING_CONTEXT;
+
+struct alignas(64) SharedMemoryWire::Base::peer_state
+{
+	/**
+	 * \brief Futex the side's reader sleeps on, the counterpart increments it after writing to the reader's ring
+	 * or freeing space in the side's own ring.
+	 */
+	std::atomic<uint32_t> doorbell;
+	std::atomic<uint32_t> sleeping;
+	std::atomic<uint32_t> wants_space;
+	std::atomic<uint32_t> attached;
+	std::atomic<int32_t> pid;
+	std::atomic<int32_t> timestamp;
+	std::atomic<uint32_t> reads_compact;
+};
+
+struct SharedMemoryWire::Base::ring_state
+{
+	alignas(64) std::atomic<uint64_t> tail;
+	alignas(64) std::atomic<uint64_t> head;
+};
+
+struct SharedMemoryWire::Base::segment_header
+{
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint64_t capacity;
+	peer_state peers[2];
+	ring_state rings[2];
+};
+
+namespace
+{
+constexpr uint32_t SEGMENT_MAGIC = 0x48534452;	  // "RDSH"
+constexpr uint32_t SEGMENT_VERSION = 1;
+
+/**
+ * \brief The rings follow the header at the next page.
+ */
+constexpr size_t DATA_OFFSET = 4096;
+
+struct chunk_header
+{
+	uint32_t size;
+	uint32_t flags;
+};
+
+// positions grow forever, the capacity is a power of two
+inline void copy_in(Buffer::word_t* ring, size_t capacity, uint64_t position, void const* source, size_t size)
+{
+	const size_t at = static_cast<size_t>(position) & (capacity - 1);
+	const size_t first = (std::min)(size, capacity - at);
+	std::memcpy(ring + at, source, first);
+	std::memcpy(ring, static_cast<Buffer::word_t const*>(source) + first, size - first);
+}
+
+inline void copy_out(void* destination, Buffer::word_t const* ring, size_t capacity, uint64_t position, size_t size)
+{
+	const size_t at = static_cast<size_t>(position) & (capacity - 1);
+	const size_t first = (std::min)(size, capacity - at);
+	std::memcpy(destination, ring + at, first);
+	std::memcpy(static_cast<Buffer::word_t*>(destination) + first, ring, size - first);
+}
+
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+	timespec relative{};
+	relative.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+	relative.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+	// not private, the word is shared with another process
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t>* word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+inline size_t segment_size(size_t capacity)
+{
+	return DATA_OFFSET + 2 * capacity;
+}
+
+inline bool is_dead(int32_t pid)
+{
+	return pid != 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+}	 // namespace
+
+SharedMemoryWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler, int side)
+	: WireBase(scheduler), id(std::move(id)), side(side), lifetimeDef(parentLifetime)
+{
+	static_assert(sizeof(segment_header) <= DATA_OFFSET, "segment header must fit in front of the rings");
+}
+
+SharedMemoryWire::Base::~Base()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+SharedMemoryWire::Base::peer_state& SharedMemoryWire::Base::own() const
+{
+	return header.load(std::memory_order_acquire)->peers[side];
+}
+
+SharedMemoryWire::Base::peer_state& SharedMemoryWire::Base::counterpart() const
+{
+	return header.load(std::memory_order_acquire)->peers[1 - side];
+}
+
+bool SharedMemoryWire::Base::map(int fd, size_t size)
+{
+	if (size < segment_size(RING_CAPACITY))
+	{
+		return false;	 // not sized by the server yet
+	}
+	void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED)
+	{
+		logger->error("{}: failed to map shared memory, reason: {}", id, std::strerror(errno));
+		return false;
+	}
+	mapping = address;
+	mapping_size = size;
+	header.store(static_cast<segment_header*>(address), std::memory_order_release);
+	return true;
+}
+
+void SharedMemoryWire::Base::unmap()
+{
+	header.store(nullptr, std::memory_order_release);
+	if (mapping != nullptr)
+	{
+		munmap(mapping, mapping_size);
+		mapping = nullptr;
+	}
+}
+
+void SharedMemoryWire::Base::ring(peer_state& peer) const
+{
+	peer.doorbell.fetch_add(1, std::memory_order_seq_cst);
+	if (peer.sleeping.load(std::memory_order_seq_cst) != 0)
+	{
+		futex_wake(&peer.doorbell);
+	}
+}
+
+void SharedMemoryWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
+
+	Buffer buffer;
+	rd_id.write(buffer);
+	const size_t context_position = buffer.get_position();
+	buffer.write_fixed_integral<int16_t>(0);	// placeholder for context
+	if (compactEncoding && counterpart_reads_compact)
+	{
+		buffer.set_encoding(Buffer::Encoding::Compact);
+	}
+	writer(buffer);	   // write rest, the writer may fall back to the fixed encoding
+	if (buffer.get_encoding() == Buffer::Encoding::Compact)
+	{
+		const size_t len = buffer.get_position();
+		buffer.set_position(context_position);
+		buffer.write_fixed_integral<int16_t>(COMPACT_ENCODING_CONTEXT);
+		buffer.set_position(len);
+	}
+	if (WireStatistics* statistics = message_broker.get_statistics())
+	{
+		statistics->on_sent(rd_id, buffer.get_position() - context_position);
+	}
+
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	if (stopping)
+	{
+		return;	   // nobody would ever write it
+	}
+	backlog.push_back(std::move(buffer).getRealArray());
+	if (header.load(std::memory_order_acquire) == nullptr)
+	{
+		return;	   // written by the reader thread once attached
+	}
+	flush_backlog();
+	if (!backlog.empty())
+	{
+		// the reader thread writes the rest once the counterpart has made space
+		own().wants_space.store(1, std::memory_order_seq_cst);
+		ring(own());
+	}
+}
+
+bool SharedMemoryWire::Base::flush_backlog() const
+{
+	segment_header* h = header.load(std::memory_order_acquire);
+	ring_state& out = h->rings[side];
+	Buffer::word_t* data = static_cast<Buffer::word_t*>(mapping) + DATA_OFFSET + side * RING_CAPACITY;
+
+	const uint64_t start = out.tail.load(std::memory_order_relaxed);
+	uint64_t tail = start;
+	uint64_t head = out.head.load(std::memory_order_acquire);
+	bool full = false;
+	while (!backlog.empty() && !full)
+	{
+		Buffer::ByteArray const& message = backlog.front();
+		while (backlog_offset < message.size())
+		{
+			const size_t size = (std::min)(message.size() - backlog_offset, MAX_CHUNK_SIZE);
+			const size_t needed = sizeof(chunk_header) + size;
+			if (RING_CAPACITY - (tail - head) < needed)
+			{
+				head = out.head.load(std::memory_order_seq_cst);
+				if (RING_CAPACITY - (tail - head) < needed)
+				{
+					blocked_head = head;
+					full = true;
+					break;
+				}
+			}
+			chunk_header chunk{static_cast<uint32_t>(size), 0};
+			if (backlog_offset == 0)
+			{
+				chunk.flags |= FIRST_CHUNK;
+			}
+			if (backlog_offset + size == message.size())
+			{
+				chunk.flags |= LAST_CHUNK;
+			}
+			copy_in(data, RING_CAPACITY, tail, &chunk, sizeof(chunk));
+			copy_in(data, RING_CAPACITY, tail + sizeof(chunk), message.data() + backlog_offset, size);
+			tail += needed;
+			backlog_offset += size;
+		}
+		if (!full)
+		{
+			backlog.pop_front();
+			backlog_offset = 0;
+		}
+	}
+
+	if (tail == start)
+	{
+		return false;
+	}
+	out.tail.store(tail, std::memory_order_seq_cst);
+	ring(counterpart());
+	return true;
+}
+
+bool SharedMemoryWire::Base::flush()
+{
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	if (backlog.empty())
+	{
+		return false;
+	}
+	const bool written = flush_backlog();
+	own().wants_space.store(backlog.empty() ? 0 : 1, std::memory_order_seq_cst);
+	return written;
+}
+
+bool SharedMemoryWire::Base::drain()
+{
+	segment_header* h = header.load(std::memory_order_acquire);
+	ring_state& in = h->rings[1 - side];
+	Buffer::word_t const* data = static_cast<Buffer::word_t const*>(mapping) + DATA_OFFSET + (1 - side) * RING_CAPACITY;
+
+	uint64_t head = in.head.load(std::memory_order_relaxed);
+	uint64_t tail = in.tail.load(std::memory_order_acquire);
+	if (head == tail)
+	{
+		return false;
+	}
+	while (head != tail)
+	{
+		chunk_header chunk{};
+		copy_out(&chunk, data, RING_CAPACITY, head, sizeof(chunk));
+		const uint64_t payload = head + sizeof(chunk);
+		// a first chunk starts with the id of its message
+		const size_t min_size = (chunk.flags & FIRST_CHUNK) != 0 ? sizeof(partial_id) : 0;
+		if (chunk.size > MAX_CHUNK_SIZE || chunk.size < min_size || payload + chunk.size > tail)
+		{
+			logger->error("{}: invalid chunk, size={}, flags={}, available={}", id, chunk.size, chunk.flags, tail - payload);
+			detach_on_protocol_error();
+			return true;
+		}
+		head = payload + chunk.size;
+
+		if ((chunk.flags & FIRST_CHUNK) != 0)
+		{
+			copy_out(&partial_id, data, RING_CAPACITY, payload, sizeof(partial_id));
+			assembling = true;
+			if ((chunk.flags & LAST_CHUNK) != 0)
+			{
+				// the only copy of the message, it's owned by the scheduler of its entity until handled
+				Buffer message{chunk.size - sizeof(partial_id)};
+				copy_out(message.data(), data, RING_CAPACITY, payload + sizeof(partial_id), chunk.size - sizeof(partial_id));
+				in.head.store(head, std::memory_order_seq_cst);
+				dispatch(partial_id, std::move(message));
+				assembling = false;
+			}
+			else
+			{
+				partial_message.resize(chunk.size - sizeof(partial_id));
+				copy_out(partial_message.data(), data, RING_CAPACITY, payload + sizeof(partial_id), partial_message.size());
+				in.head.store(head, std::memory_order_seq_cst);
+			}
+		}
+		else if (assembling)
+		{
+			const size_t at = partial_message.size();
+			partial_message.resize(at + chunk.size);
+			copy_out(partial_message.data() + at, data, RING_CAPACITY, payload, chunk.size);
+			in.head.store(head, std::memory_order_seq_cst);
+			if ((chunk.flags & LAST_CHUNK) != 0)
+			{
+				dispatch(partial_id, Buffer{std::move(partial_message)});
+				partial_message = Buffer::ByteArray{};
+				assembling = false;
+			}
+		}
+		else
+		{
+			in.head.store(head, std::memory_order_seq_cst);
+		}
+
+		if (counterpart().wants_space.load(std::memory_order_seq_cst) != 0)
+		{
+			ring(counterpart());
+		}
+		if (head == tail)
+		{
+			tail = in.tail.load(std::memory_order_acquire);
+		}
+	}
+	return true;
+}
+
+void SharedMemoryWire::Base::detach_on_protocol_error()
+{
+	// nothing after a broken chunk can be told apart from garbage
+	stopping = true;
+	assembling = false;
+	partial_message = Buffer::ByteArray{};
+	own().attached.store(0, std::memory_order_seq_cst);
+	ring(counterpart());
+	connected.set(false);
+}
+
+void SharedMemoryWire::Base::dispatch(RdId::hash_t id_, Buffer message)
+{
+	if (id_ == -1)
+	{
+		logger->error("id == -1");
+		return;
+	}
+	const int16_t context = message.read_fixed_integral<int16_t>();
+	message.rewind();	 // context is skipped by the broker
+	if ((context & COMPACT_ENCODING_CONTEXT) != 0)
+	{
+		message.set_encoding(Buffer::Encoding::Compact);
+	}
+	message_broker.dispatch(RdId{id_}, std::move(message));
+}
+
+void SharedMemoryWire::Base::update_connection()
+{
+	peer_state& other = counterpart();
+	const bool attached = other.attached.load(std::memory_order_acquire) != 0;
+	counterpart_reads_compact = attached && other.reads_compact.load(std::memory_order_relaxed) != 0;
+	if (attached != connected.get())
+	{
+		logger->debug("{}: counterpart {}", id, attached ? "attached" : "detached");
+		connected.set(attached);
+	}
+}
+
+bool SharedMemoryWire::Base::has_input() const
+{
+	ring_state& in = header.load(std::memory_order_acquire)->rings[1 - side];
+	return in.tail.load(std::memory_order_seq_cst) != in.head.load(std::memory_order_relaxed);
+}
+
+void SharedMemoryWire::Base::wait_for_doorbell()
+{
+	peer_state& me = own();
+	const uint32_t seen = me.doorbell.load(std::memory_order_seq_cst);
+	me.sleeping.store(1, std::memory_order_seq_cst);
+	const bool space_made = me.wants_space.load(std::memory_order_seq_cst) != 0 &&
+							header.load(std::memory_order_acquire)->rings[side].head.load(std::memory_order_seq_cst) != blocked_head;
+	if (!stopping && !has_input() && !space_made)
+	{
+		// wakes up at least once per heartbeat to notice a detached counterpart
+		futex_wait(&me.doorbell, seen, heartBeatInterval);
+	}
+	me.sleeping.store(0, std::memory_order_relaxed);
+}
+
+void SharedMemoryWire::Base::run()
+{
+	rd::util::set_thread_name(id.empty() ? "SharedMemoryWire Thread" : id.c_str());
+	if (!attach())
+	{
+		return;
+	}
+	own().reads_compact.store(compactEncoding ? 1 : 0, std::memory_order_relaxed);
+	heartbeat = TimerWheel::instance().schedule(lifetimeDef.lifetime, heartBeatInterval, heartBeatInterval, [this] { ping(); });
+
+	while (!stopping)
+	{
+		update_connection();
+		bool progressed = drain();
+		// messages sent before attaching, or which didn't fit
+		progressed = flush() || progressed;
+		if (!progressed)
+		{
+			wait_for_doorbell();
+		}
+	}
+}
+
+void SharedMemoryWire::Base::ping()
+{
+	if (header.load(std::memory_order_acquire) == nullptr)
+	{
+		return;
+	}
+	own().timestamp.fetch_add(1, std::memory_order_relaxed);
+
+	peer_state& other = counterpart();
+	if (other.attached.load(std::memory_order_acquire) == 0)
+	{
+		missed_heartbeats = 0;
+		heartbeatAlive.set(false);
+		return;
+	}
+	const int32_t timestamp = other.timestamp.load(std::memory_order_relaxed);
+	if (timestamp != counterpart_timestamp)
+	{
+		counterpart_timestamp = timestamp;
+		missed_heartbeats = 0;
+		heartbeatAlive.set(true);
+		return;
+	}
+	if (++missed_heartbeats <= MaximumHeartbeatDelay)
+	{
+		return;
+	}
+	if (heartbeatAlive.get())
+	{	 // only on change
+		logger->trace("{}: counterpart missed {} heartbeats", id, missed_heartbeats);
+	}
+	heartbeatAlive.set(false);
+
+	// a process which has died can't detach itself
+	const int32_t pid = other.pid.load(std::memory_order_relaxed);
+	uint32_t expected = 1;
+	if (is_dead(pid) && other.attached.compare_exchange_strong(expected, 0))
+	{
+		logger->info("{}: counterpart process {} has died", id, pid);
+		ring(own());
+	}
+}
+
+void SharedMemoryWire::Base::stop()
+{
+	stopping = true;
+	if (header.load(std::memory_order_acquire) != nullptr)
+	{
+		ring(own());
+	}
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+	TimerWheel::instance().cancel(heartbeat);
+
+	if (header.load(std::memory_order_acquire) != nullptr)
+	{
+		own().attached.store(0, std::memory_order_seq_cst);
+		ring(counterpart());
+	}
+	connected.set(false);
+
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	unmap();
+	backlog.clear();
+	backlog_offset = 0;
+}
+
+SharedMemoryWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id)
+	: Base(id, parentLifetime, scheduler, 1), name(std::move(name))
+{
+	lifetimeDef.lifetime->add_action([this] {
+		logger->info("{}: starts terminating lifetime", this->id);
+		{
+			std::lock_guard<decltype(retry_lock)> guard(retry_lock);
+			stopping = true;
+		}
+		retry.notify_all();
+		stop();
+		logger->info("{}: termination finished", this->id);
+	});
+
+	thread = std::thread([this] { run(); });
+}
+
+SharedMemoryWire::Client::~Client()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+bool SharedMemoryWire::Client::attach()
+{
+	while (!stopping)
+	{
+		const int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+		if (fd == -1)
+		{
+			logger->debug("{}: failed to open shared memory {}, reason: {}", id, name, std::strerror(errno));
+		}
+		else
+		{
+			struct stat st{};
+			const bool mapped = fstat(fd, &st) == 0 && map(fd, static_cast<size_t>(st.st_size));
+			::close(fd);
+			segment_header* h = header.load(std::memory_order_acquire);
+			if (mapped && h->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC)
+			{
+				unmap();	// not initialized by the server yet
+			}
+			else if (mapped && (h->version != SEGMENT_VERSION || h->capacity != RING_CAPACITY))
+			{
+				logger->error("{}: shared memory {} has version {} and capacity {}", id, name, h->version, h->capacity);
+				unmap();
+			}
+			else if (mapped)
+			{
+				peer_state& me = own();
+				// a client which has died can't detach itself
+				uint32_t expected = 1;
+				if (is_dead(me.pid.load(std::memory_order_relaxed)))
+				{
+					me.attached.compare_exchange_strong(expected, 0);
+				}
+				expected = 0;
+				if (me.attached.compare_exchange_strong(expected, 1))
+				{
+					me.pid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+					me.timestamp.store(0, std::memory_order_relaxed);
+					ring(counterpart());
+					logger->info("{}: attached to shared memory {}", id, name);
+					return true;
+				}
+				logger->debug("{}: another client is attached to shared memory {}", id, name);
+				unmap();
+			}
+		}
+		std::unique_lock<decltype(retry_lock)> guard(retry_lock);
+		retry.wait_for(guard, timeout, [this] { return stopping.load(); });
+	}
+	return false;
+}
+
+SharedMemoryWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id)
+	: Base(id, parentLifetime, scheduler, 0), name(std::move(name))
+{
+	if (this->name.empty())
+	{
+		static std::atomic<uint32_t> counter{0};
+		this->name = fmt::format("/rd-{}-{}", getpid(), counter++);
+	}
+	int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+	if (fd == -1 && errno == EEXIST)
+	{
+		// left behind by a server which didn't terminate cleanly
+		logger->warn("{}: replacing stale shared memory {}", this->id, this->name);
+		shm_unlink(this->name.c_str());
+		fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+	}
+	RD_ASSERT_THROW_MSG(fd != -1,
+		fmt::format("{}: failed to create shared memory {}, reason: {}", this->id, this->name, std::strerror(errno)))
+	const size_t size = segment_size(RING_CAPACITY);
+	const bool mapped = ftruncate(fd, static_cast<off_t>(size)) == 0 && map(fd, size);
+	const int error = errno;
+	::close(fd);
+	if (!mapped)
+	{
+		shm_unlink(this->name.c_str());
+	}
+	RD_ASSERT_THROW_MSG(mapped,
+		fmt::format("{}: failed to size shared memory {}, reason: {}", this->id, this->name, std::strerror(error)))
+
+	segment_header* h = header.load(std::memory_order_acquire);
+	h->version = SEGMENT_VERSION;
+	h->capacity = RING_CAPACITY;
+	own().pid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+	own().attached.store(1, std::memory_order_relaxed);
+	h->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+	logger->info("{}: created shared memory {}", this->id, this->name);
+
+	lifetimeDef.lifetime->add_action([this] {
+		logger->info("{}: start terminating lifetime", this->id);
+		stop();
+		shm_unlink(this->name.c_str());
+		logger->info("{}: termination finished", this->id);
+	});
+
+	thread = std::thread([this] { run(); });
+}
+
+SharedMemoryWire::Server::~Server()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+bool SharedMemoryWire::Server::attach()
+{
+	return true;	// the segment is created by the constructor
+}
+}	 // namespace rd
+
+#endif	  // RD_SHARED_MEMORY_WIRE
@@ -0,0 +1,255 @@
+#ifndef RD_CPP_SHAREDMEMORYWIRE_H
+#define RD_CPP_SHAREDMEMORYWIRE_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#if defined(__linux__)
+#define RD_SHARED_MEMORY_WIRE
+#endif
+
+#ifdef RD_SHARED_MEMORY_WIRE
+
+#include "scheduler/base/IScheduler.h"
+#include "scheduler/TimerWheel.h"
+#include "base/WireBase.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Wire between processes of the same host which exchanges messages through a POSIX shared memory segment
+ * instead of a socket. The segment holds a single-producer/single-consumer ring per direction, a reader is woken
+ * with a futex in the segment. The server creates the segment under [Server::name], a client attaches to it by name.
+ *
+ * A message is delivered once it is in the ring, the consumer's position acknowledges it. Messages which the
+ * counterpart hasn't read when it goes away stay in the ring for the next client, like [SocketWire] sends
+ * unacknowledged packages again after a reconnect. A segment lives as long as its server.
+ */
+class RD_FRAMEWORK_API SharedMemoryWire
+{
+	static std::chrono::milliseconds timeout;
+
+public:
+	class RD_FRAMEWORK_API Base : public WireBase
+	{
+	protected:
+		struct peer_state;
+		struct ring_state;
+		struct segment_header;
+
+		static std::shared_ptr<spdlog::logger> logger;
+
+		static constexpr size_t RING_CAPACITY = size_t{1} << 20;
+
+		/**
+		 * \brief Larger messages are written in chunks, so that the reader frees space while the writer goes on.
+		 */
+		static constexpr size_t MAX_CHUNK_SIZE = RING_CAPACITY / 4;
+
+		static constexpr uint32_t FIRST_CHUNK = 1;
+		static constexpr uint32_t LAST_CHUNK = 2;
+
+		/**
+		 * \brief Bit of the message context set for messages written in [Buffer::Encoding::Compact], as in [SocketWire].
+		 * Whether a side reads it is in its peer state instead of an announcement message.
+		 */
+		static constexpr int16_t COMPACT_ENCODING_CONTEXT = 0x4000;
+
+		std::string id;
+
+		/**
+		 * \brief 0 for the server, 1 for the client. Each side writes the ring and owns the peer state of its index.
+		 */
+		const int side;
+
+		void* mapping = nullptr;
+		size_t mapping_size = 0;
+		std::atomic<segment_header*> header{nullptr};
+
+		std::thread thread;
+		std::atomic<bool> stopping{false};
+
+		// region guarded by send_lock
+
+		mutable std::mutex send_lock;
+
+		/**
+		 * \brief Messages which didn't fit into the ring yet, [backlog_offset] bytes of the front one are written.
+		 */
+		mutable std::deque<Buffer::ByteArray> backlog;
+		mutable size_t backlog_offset = 0;
+
+		// endregion
+
+		/**
+		 * \brief Position of the outgoing ring's reader when the backlog last didn't fit, the reader thread
+		 * doesn't sleep once it has moved.
+		 */
+		mutable std::atomic<uint64_t> blocked_head{0};
+
+		std::atomic<bool> counterpart_reads_compact{false};
+
+		// region reader thread only
+
+		/**
+		 * \brief Message whose chunks are being read, without its id. Chunks which don't belong to a message
+		 * started by this reader are skipped, e.g. after a reader of the previous client went away in the middle.
+		 */
+		Buffer::ByteArray partial_message;
+		RdId::hash_t partial_id = 0;
+		bool assembling = false;
+
+		// endregion
+
+		// region heartbeat only
+
+		int32_t counterpart_timestamp = 0;
+		int32_t missed_heartbeats = 0;
+
+		// endregion
+
+		TimerWheel::timer_id heartbeat = 0;
+
+		peer_state& own() const;
+
+		peer_state& counterpart() const;
+
+		/**
+		 * \brief Maps an existing segment of [fd], the server creates it first.
+		 */
+		bool map(int fd, size_t size);
+
+		void unmap();
+
+		/**
+		 * \brief Writes as much of [backlog] as the ring takes. Must be called under [send_lock].
+		 *
+		 * \return true if anything was written
+		 */
+		bool flush_backlog() const;
+
+		/**
+		 * \brief Writes the backlog from the reader thread, returns true if anything was written.
+		 */
+		bool flush();
+
+		/**
+		 * \brief Reads and dispatches everything in the incoming ring, returns false if it was empty.
+		 * A chunk which can't have been written by a counterpart ends reading with [detach_on_protocol_error].
+		 */
+		bool drain();
+
+		/**
+		 * \brief The incoming ring can't be read any further: stops the reading thread and detaches from the segment.
+		 */
+		void detach_on_protocol_error();
+
+		void dispatch(RdId::hash_t id_, Buffer message);
+
+		void update_connection();
+
+		bool has_input() const;
+
+		void wait_for_doorbell();
+
+		void ring(peer_state& peer) const;
+
+		void run();
+
+		/**
+		 * \brief Called on the reader thread until the segment is mapped, returns false if the wire is terminated.
+		 */
+		virtual bool attach() = 0;
+
+		/**
+		 * \brief Stops the reader and the heartbeat and detaches from the segment.
+		 */
+		void stop();
+
+	public:
+		static constexpr int32_t MaximumHeartbeatDelay = 3;
+		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
+
+		bool compactEncoding = true;
+
+		// region ctor/dtor
+
+		Base(std::string id, Lifetime lifetime, IScheduler* scheduler, int side);
+
+		virtual ~Base() override;
+
+		// endregion
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+
+		void ping();
+
+	protected:
+		LifetimeDefinition lifetimeDef;
+	};
+
+	class RD_FRAMEWORK_API Client : public Base
+	{
+		std::mutex retry_lock;
+		std::condition_variable retry;
+
+		bool attach() override;
+
+	public:
+		std::string name;
+
+		// region ctor/dtor
+
+		Client(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id = "ClientSharedMemory");
+
+		virtual ~Client() override;
+
+		// endregion
+	};
+
+	class RD_FRAMEWORK_API Server : public Base
+	{
+		bool attach() override;
+
+	public:
+		/**
+		 * \brief Name of the segment to pass to the client, generated unless given.
+		 */
+		std::string name;
+
+		// region ctor/dtor
+
+		/**
+		 * \brief Creates the segment, a stale one left under [name] by a crashed server is replaced.
+		 * Throws std::runtime_error if the segment can't be created.
+		 */
+		Server(Lifetime lifetime, IScheduler* scheduler, std::string name = "", const std::string& id = "ServerSharedMemory");
+
+		virtual ~Server() override;
+
+		// endregion
+	};
+};
+}	 // namespace rd
+
+#endif	  // RD_SHARED_MEMORY_WIRE
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SHAREDMEMORYWIRE_H
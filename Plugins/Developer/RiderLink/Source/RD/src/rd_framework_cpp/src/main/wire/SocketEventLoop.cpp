@@ -0,0 +1,215 @@
+#include "SocketEventLoop.h"
+
+#ifdef RD_SOCKET_EVENT_LOOP
+
+#include "util/core_util.h"
+#include "util/thread_util.h"
+
+#include "spdlog/spdlog.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace rd
+{
+constexpr int SocketEventLoop::MAX_EVENTS;
+
+namespace
+{
+// the wake eventfd is told apart by its generation, registered descriptors never get zero
+constexpr uint32_t WAKE_GENERATION = 0;
+
+inline uint64_t pack(int fd, uint32_t generation)
+{
+	return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+}	 // namespace
+
+SocketEventLoop::SocketEventLoop(std::string name) : name(std::move(name))
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	RD_ASSERT_MSG(epoll_fd != -1, fmt::format("{}: failed to create epoll, reason: {}", this->name, std::strerror(errno)))
+	wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	RD_ASSERT_MSG(wake_fd != -1, fmt::format("{}: failed to create eventfd, reason: {}", this->name, std::strerror(errno)))
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u64 = pack(wake_fd, WAKE_GENERATION);
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+	thread = std::thread([this] {
+		rd::util::set_thread_name(this->name.c_str());
+		run();
+	});
+}
+
+SocketEventLoop::~SocketEventLoop()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		stopping = true;
+	}
+	wake();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+	close(wake_fd);
+	close(epoll_fd);
+}
+
+SocketEventLoop& SocketEventLoop::instance()
+{
+	static SocketEventLoop loop("rd-socket-loop");
+	return loop;
+}
+
+void SocketEventLoop::wake() const
+{
+	const uint64_t one = 1;
+	// a full counter still wakes the loop up
+	(void) !write(wake_fd, &one, sizeof(one));
+}
+
+void SocketEventLoop::run()
+{
+	std::array<epoll_event, MAX_EVENTS> events{};
+	while (true)
+	{
+		const int ready = epoll_wait(epoll_fd, events.data(), MAX_EVENTS, -1);
+		if (ready == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			spdlog::error("{}: epoll_wait failed, reason: {}", name, std::strerror(errno));
+			return;
+		}
+
+		std::unique_lock<decltype(lock)> guard(lock);
+		for (int i = 0; i < ready; ++i)
+		{
+			const int fd = static_cast<int>(static_cast<uint32_t>(events[i].data.u64));
+			const auto generation = static_cast<uint32_t>(events[i].data.u64 >> 32);
+			if (generation == WAKE_GENERATION)
+			{
+				uint64_t count;
+				(void) !read(wake_fd, &count, sizeof(count));
+				continue;
+			}
+			auto it = handlers.find(fd);
+			if (it == handlers.end() || it->second.generation != generation)
+			{
+				continue;	 // removed by a handler earlier in this batch
+			}
+			// the handler may remove or replace its registration, keep it alive until it returns
+			handler_t handler = it->second.handler;
+			running = fd;
+			guard.unlock();
+			try
+			{
+				handler(events[i].events);
+			}
+			catch (std::exception const& e)
+			{
+				spdlog::error("{}: socket handler failed | {}", name, e.what());
+			}
+			guard.lock();
+			running = -1;
+			finished.notify_all();
+		}
+
+		if (stopping)
+		{
+			return;
+		}
+		std::vector<std::function<void()>> actions;
+		actions.swap(posted);
+		guard.unlock();
+		for (auto& action : actions)
+		{
+			try
+			{
+				action();
+			}
+			catch (std::exception const& e)
+			{
+				spdlog::error("{}: posted action failed | {}", name, e.what());
+			}
+		}
+	}
+}
+
+void SocketEventLoop::add(int fd, uint32_t events, handler_t handler)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	const uint32_t generation = next_generation++;
+	if (next_generation == WAKE_GENERATION)
+	{
+		++next_generation;
+	}
+	handlers[fd] = registration{generation, std::move(handler)};
+
+	epoll_event event{};
+	event.events = events;
+	event.data.u64 = pack(fd, generation);
+	RD_ASSERT_THROW_MSG(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0,
+		fmt::format("{}: failed to watch descriptor {}, reason: {}", name, fd, std::strerror(errno)))
+}
+
+void SocketEventLoop::modify(int fd, uint32_t events)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	auto it = handlers.find(fd);
+	if (it == handlers.end())
+	{
+		return;
+	}
+	epoll_event event{};
+	event.events = events;
+	event.data.u64 = pack(fd, it->second.generation);
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void SocketEventLoop::remove(int fd)
+{
+	handler_t handler;
+	{
+		std::unique_lock<decltype(lock)> guard(lock);
+		auto it = handlers.find(fd);
+		if (it != handlers.end())
+		{
+			handler = std::move(it->second.handler);
+			handlers.erase(it);
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+		}
+		if (!is_loop_thread())
+		{
+			finished.wait(guard, [this, fd] { return running != fd; });
+		}
+	}
+	// released outside of the lock, it may hold the last references to its owner's state
+}
+
+void SocketEventLoop::post(std::function<void()> action)
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		posted.push_back(std::move(action));
+	}
+	wake();
+}
+
+bool SocketEventLoop::is_loop_thread() const
+{
+	return std::this_thread::get_id() == thread.get_id();
+}
+}	 // namespace rd
+
+#endif	  // RD_SOCKET_EVENT_LOOP
@@ -0,0 +1,129 @@
+#ifndef RD_CPP_SOCKETEVENTLOOP_H
+#define RD_CPP_SOCKETEVENTLOOP_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#if defined(__linux__)
+#define RD_SOCKET_EVENT_LOOP
+#endif
+
+#ifdef RD_SOCKET_EVENT_LOOP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Waits for readiness of any number of non-blocking descriptors with epoll and runs their handlers on a single thread.
+ * Handlers get the ready epoll events and must not block, they read and write until the descriptor would block.
+ */
+class RD_FRAMEWORK_API SocketEventLoop
+{
+public:
+	using handler_t = std::function<void(uint32_t events)>;
+
+private:
+	static constexpr int MAX_EVENTS = 64;
+
+	struct registration
+	{
+		uint32_t generation;
+		handler_t handler;
+	};
+
+	std::string name;
+
+	int epoll_fd = -1;
+
+	/**
+	 * \brief eventfd which wakes the loop up for [posted] actions and for stopping.
+	 */
+	int wake_fd = -1;
+
+	// region guarded by lock
+
+	std::mutex lock;
+	std::condition_variable finished;
+
+	/**
+	 * \brief Registered descriptors, the generation tells events of a removed descriptor from ones of a new descriptor
+	 * with the same number.
+	 */
+	std::unordered_map<int, registration> handlers;
+	uint32_t next_generation = 1;
+
+	std::vector<std::function<void()>> posted;
+
+	int running = -1;
+	bool stopping = false;
+
+	// endregion
+
+	std::thread thread;
+
+	void wake() const;
+
+	void run();
+
+public:
+	// region ctor/dtor
+
+	explicit SocketEventLoop(std::string name);
+
+	SocketEventLoop(SocketEventLoop const&) = delete;
+
+	SocketEventLoop& operator=(SocketEventLoop const&) = delete;
+
+	virtual ~SocketEventLoop();
+
+	// endregion
+
+	/**
+	 * \brief The loop shared by all event loop wires of the process.
+	 */
+	static SocketEventLoop& instance();
+
+	/**
+	 * \brief Starts watching [fd] for [events] (level-triggered), [handler] is called on the loop's thread.
+	 */
+	void add(int fd, uint32_t events, handler_t handler);
+
+	/**
+	 * \brief Replaces the events [fd] is watched for, zero keeps it registered but silent.
+	 */
+	void modify(int fd, uint32_t events);
+
+	/**
+	 * \brief Stops watching [fd], once it returns the handler is not running and won't run again
+	 * (unless it is called by the handler itself). The descriptor may be closed afterwards.
+	 */
+	void remove(int fd);
+
+	/**
+	 * \brief Runs [action] on the loop's thread.
+	 */
+	void post(std::function<void()> action);
+
+	bool is_loop_thread() const;
+};
+}	 // namespace rd
+
+#endif	  // RD_SOCKET_EVENT_LOOP
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SOCKETEVENTLOOP_H
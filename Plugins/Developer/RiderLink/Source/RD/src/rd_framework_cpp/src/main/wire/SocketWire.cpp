@@ -1,5 +1,7 @@
 #include "wire/SocketWire.h"
 
+#include "scheduler/TimerWheel.h"
+
 #include <util/thread_util.h>
 
 #include "spdlog/sinks/stdout_color_sinks.h"
@@ -10,10 +12,211 @@
 
 #include <utility>
 #include <thread>
+#include <cstring>
 #include <csignal>
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+#ifdef RD_UNIX_DOMAIN_SOCKET
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 namespace rd
 {
+namespace
+{
+/**
+ * \brief Waits up to [timeout_ms] for [events] on [socket], errors count as ready so that the next call reports them.
+ * poll rather than select, a process may well have descriptors beyond FD_SETSIZE.
+ */
+bool wait_for(CSimpleSocket& socket, short events, int timeout_ms)
+{
+	if (!socket.IsSocketValid())
+	{
+		return false;
+	}
+#if defined(_WIN32)
+	WSAPOLLFD entry{};
+	entry.fd = socket.GetSocketDescriptor();
+	entry.events = events;
+	return WSAPoll(&entry, 1, timeout_ms) > 0 && entry.revents != 0;
+#else
+	pollfd entry{};
+	entry.fd = socket.GetSocketDescriptor();
+	entry.events = events;
+	return ::poll(&entry, 1, timeout_ms) > 0 && entry.revents != 0;
+#endif
+}
+
+/**
+ * \brief Whether [socket] takes a short message without blocking, a stream socket is reported writable only while
+ * a good part of its send buffer is free.
+ */
+bool is_writable(CSimpleSocket& socket)
+{
+	return wait_for(socket, POLLOUT, 0);
+}
+}	 // namespace
+
+#ifdef RD_UNIX_DOMAIN_SOCKET
+namespace
+{
+bool is_abstract_socket_path(std::string const& path)
+{
+#if defined(__linux__)
+	return !path.empty() && path[0] == '@';
+#else
+	(void) path;
+	return false;
+#endif
+}
+
+/**
+ * \brief Fills [address] for [path], returns the length of the address or 0 if [path] doesn't fit in it.
+ */
+socklen_t unix_socket_address(std::string const& path, sockaddr_un& address)
+{
+	std::memset(&address, 0, sizeof(address));
+	if (path.empty() || path.size() >= sizeof(address.sun_path))
+	{
+		return 0;
+	}
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.data(), path.size());
+	if (is_abstract_socket_path(path))
+	{
+		// the name of an abstract socket starts with a zero byte and isn't terminated
+		address.sun_path[0] = '\0';
+		return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+	}
+	return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+}
+
+std::string unique_socket_path()
+{
+	static std::atomic<int32_t> counter{0};
+#if defined(__linux__)
+	return fmt::format("@rd-{}-{}", getpid(), counter++);
+#else
+	const char* tmp = std::getenv("TMPDIR");
+	std::string dir = tmp != nullptr && *tmp != '\0' ? tmp : "/tmp";
+	if (dir.back() == '/')
+	{
+		dir.pop_back();
+	}
+	return fmt::format("{}/rd-{}-{}.sock", dir, getpid(), counter++);
+#endif
+}
+
+/**
+ * \brief clsocket creates IP sockets only, but its stream socket reads and writes any connected descriptor:
+ * the Unix domain socket is connected here and handed over to it.
+ */
+class UnixActiveSocket : public CActiveSocket
+{
+public:
+	bool Connect(std::string const& path)
+	{
+		sockaddr_un address{};
+		const socklen_t length = unix_socket_address(path, address);
+		if (length == 0)
+		{
+			SetSocketError(SocketInvalidAddress);
+			return false;
+		}
+		const SOCKET handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (handle == INVALID_SOCKET)
+		{
+			TranslateSocketError();
+			return false;
+		}
+		int result;
+		do
+		{
+			result = ::connect(handle, reinterpret_cast<sockaddr*>(&address), length);
+		} while (result != 0 && errno == EINTR);
+		if (result != 0)
+		{
+			TranslateSocketError();
+			::close(handle);
+			return false;
+		}
+		Adopt(handle);
+		return true;
+	}
+
+	void Adopt(SOCKET handle)
+	{
+		SetSocketHandle(handle);
+		SetSocketError(SocketSuccess);
+	}
+};
+
+class UnixPassiveSocket : public CPassiveSocket
+{
+public:
+	/**
+	 * \brief Binds [path] replacing a stale socket file, there is no SO_REUSEADDR for Unix domain sockets.
+	 */
+	bool Listen(std::string const& path, int32_t backlog = 30000)
+	{
+		sockaddr_un address{};
+		const socklen_t length = unix_socket_address(path, address);
+		if (length == 0)
+		{
+			SetSocketError(SocketInvalidAddress);
+			return false;
+		}
+		const SOCKET handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (handle == INVALID_SOCKET)
+		{
+			TranslateSocketError();
+			return false;
+		}
+		if (!is_abstract_socket_path(path))
+		{
+			::unlink(path.c_str());
+		}
+		if (::bind(handle, reinterpret_cast<sockaddr*>(&address), length) != 0 || ::listen(handle, backlog) != 0)
+		{
+			TranslateSocketError();
+			::close(handle);
+			return false;
+		}
+		SetSocketHandle(handle);
+		SetSocketError(SocketSuccess);
+		return true;
+	}
+
+	CActiveSocket* Accept() override
+	{
+		SOCKET handle;
+		do
+		{
+			handle = ::accept(GetSocketDescriptor(), nullptr, nullptr);
+		} while (handle == INVALID_SOCKET && errno == EINTR);
+		if (handle == INVALID_SOCKET)
+		{
+			TranslateSocketError();
+			return nullptr;
+		}
+		auto* accepted = new UnixActiveSocket();
+		accepted->Adopt(handle);
+		return accepted;
+	}
+};
+}	 // namespace
+#endif
+
 std::shared_ptr<spdlog::logger> SocketWire::Base::logger =
 	spdlog::stderr_color_mt<spdlog::synchronous_factory>("wireLog", spdlog::color_mode::automatic);
 
@@ -22,6 +225,9 @@ std::chrono::milliseconds SocketWire::timeout = std::chrono::milliseconds(500);
 constexpr int32_t SocketWire::Base::ACK_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PING_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PACKAGE_HEADER_LENGTH;
+constexpr RdId::hash_t SocketWire::Base::ENCODING_MESSAGE_ID;
+constexpr sequence_number_t SocketWire::Base::ENCODING_ANNOUNCEMENT_SEQN;
+constexpr int16_t SocketWire::Base::COMPACT_ENCODING_CONTEXT;
 
 SocketWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler)
 	: WireBase(scheduler), id(std::move(id)), scheduler(scheduler), lifetimeDef(parentLifetime)
@@ -41,6 +247,15 @@ SocketWire::Base::~Base()
 
 void SocketWire::Base::receiverProc() const
 {
+	// acknowledges sent before a reconnect might have been lost
+	sent_ack_seqn = 0;
+	unacked_packages = 0;
+
+	// leftovers of the previous connection
+	lo = hi = receiver_buffer.begin();
+	current_package_seqn = 0;
+	receive_pkg.rewind();
+
 	while (!lifetimeDef.lifetime->is_terminated())
 	{
 		try
@@ -68,26 +283,20 @@ void SocketWire::Base::receiverProc() const
 	}
 }
 
-bool SocketWire::Base::send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const
+bool SocketWire::Base::send0(Buffer::ByteArray& pkg, sequence_number_t seqn) const
 {
 	try
 	{
 		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
 
-		int32_t msglen = static_cast<int32_t>(msg.size());
-
-		send_package_header.rewind();
-		send_package_header.write_integral(msglen);
-		send_package_header.write_integral(seqn);
+		// header space was reserved in front of the message by send(), patch it in place and send everything at once
+		int32_t msglen = static_cast<int32_t>(pkg.size()) - PACKAGE_HEADER_LENGTH;
+		int32_t pkglen = static_cast<int32_t>(pkg.size());
 
-		RD_ASSERT_THROW_MSG(
-			socket_provider->Send(send_package_header.data(), send_package_header.get_position()) == PACKAGE_HEADER_LENGTH,
-			this->id +
-				": failed to send header over the network"
-				", reason: " +
-				socket_provider->DescribeError())
+		std::memcpy(pkg.data(), &msglen, sizeof(msglen));
+		std::memcpy(pkg.data() + sizeof(msglen), &seqn, sizeof(seqn));
 
-		RD_ASSERT_THROW_MSG(socket_provider->Send(msg.data(), msglen) == msglen, this->id +
+		RD_ASSERT_THROW_MSG(socket_provider->Send(pkg.data(), pkglen) == pkglen, this->id +
 																					 ": failed to send package over the network"
 																					 ", reason: " +
 																					 socket_provider->DescribeError());
@@ -107,20 +316,114 @@ void SocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer
 {
 	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
 
-	Buffer local_send_buffer;
-	local_send_buffer.write_integral<int32_t>(0);	 // placeholder for length
-	rd_id.write(local_send_buffer);					 // write id
-	local_send_buffer.write_integral<int16_t>(0);	 // placeholder for context
-	writer(local_send_buffer);						 // write rest
+	Buffer local_send_buffer{async_send_buffer.acquire_slab(), PACKAGE_HEADER_LENGTH};	// package header is patched by send0
+	local_send_buffer.write_fixed_integral<int32_t>(0);	   // placeholder for length
+	rd_id.write(local_send_buffer);						   // write id
+	const size_t context_position = local_send_buffer.get_position();
+	local_send_buffer.write_fixed_integral<int16_t>(0);	   // placeholder for context
+	if (compactEncoding && counterpart_reads_compact)
+	{
+		local_send_buffer.set_encoding(Buffer::Encoding::Compact);
+	}
+	writer(local_send_buffer);	  // write rest, the writer may fall back to the fixed encoding
 
 	int32_t len = static_cast<int32_t>(local_send_buffer.get_position());
 
-	local_send_buffer.rewind();
-	local_send_buffer.write_integral<int32_t>(len - 4);
+	local_send_buffer.set_position(PACKAGE_HEADER_LENGTH);
+	local_send_buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH - 4);
+	if (local_send_buffer.get_encoding() == Buffer::Encoding::Compact)
+	{
+		local_send_buffer.set_position(context_position);
+		local_send_buffer.write_fixed_integral<int16_t>(COMPACT_ENCODING_CONTEXT);
+	}
 	local_send_buffer.set_position(len);
+	WireStatistics* statistics = message_broker.get_statistics();
+	if (statistics != nullptr)
+	{
+		statistics->on_sent(rd_id, static_cast<size_t>(len - PACKAGE_HEADER_LENGTH - 4 - 8));	 // without length and id
+	}
 	async_send_buffer.put(std::move(local_send_buffer).getRealArray());
 }
 
+void SocketWire::Base::announce_encoding() const
+{
+	counterpart_reads_compact = false;
+	counterpart_encodings_known = false;
+
+	Buffer buffer{Buffer::ByteArray(PACKAGE_HEADER_LENGTH + 16), PACKAGE_HEADER_LENGTH};	// package header is patched by send0
+	buffer.write_fixed_integral<int32_t>(0);	// placeholder for length
+	RdId{ENCODING_MESSAGE_ID}.write(buffer);
+	buffer.write_fixed_integral<int16_t>(0);	// context
+	buffer.write_integral<uint8_t>(compactEncoding ? 1u << static_cast<uint8_t>(Buffer::Encoding::Compact) : 0u);
+	const int32_t len = static_cast<int32_t>(buffer.get_position());
+	buffer.set_position(PACKAGE_HEADER_LENGTH);
+	buffer.write_fixed_integral<int32_t>(len - PACKAGE_HEADER_LENGTH - 4);
+	buffer.set_position(len);
+
+	Buffer::ByteArray pkg = std::move(buffer).getRealArray();
+	send0(pkg, ENCODING_ANNOUNCEMENT_SEQN);
+}
+
+void SocketWire::Base::on_counterpart_encodings(uint8_t encodings) const
+{
+	counterpart_encodings_known = true;
+	counterpart_reads_compact = (encodings & (1u << static_cast<uint8_t>(Buffer::Encoding::Compact))) != 0;
+	logger->debug("{}: counterpart reads encodings {}", this->id, encodings);
+	if (sending_resumed)
+	{
+		return;
+	}
+	if (!counterpart_reads_compact)
+	{
+		// neither rd-net nor an older rd-cpp look at the context, they would misread these messages
+		const size_t dropped = async_send_buffer.discard_unacknowledged(is_compact_package);
+		logger->warn("{}: counterpart doesn't read the compact encoding, dropped {} packages written for the previous one",
+			this->id, dropped);
+	}
+	sending_resumed = true;
+	async_send_buffer.resume();
+}
+
+bool SocketWire::Base::read_encoding_announcement(int32_t len) const
+{
+	// message length, id and context come first, anything after the encodings is left to later versions
+	constexpr int32_t encodings_position = sizeof(int32_t) + sizeof(RdId::hash_t) + sizeof(int16_t);
+	std::array<Buffer::word_t, 64> body{};
+	if (len <= encodings_position || len > static_cast<int32_t>(body.size()))
+	{
+		logger->error("{}: invalid encoding announcement, len={}", this->id, len);
+		return false;
+	}
+	if (!read_data_from_socket(body.data(), static_cast<size_t>(len)))
+	{
+		return false;
+	}
+	RdId::hash_t announced_id;
+	std::memcpy(&announced_id, body.data() + sizeof(int32_t), sizeof(announced_id));
+	if (announced_id != ENCODING_MESSAGE_ID)
+	{
+		logger->error("{}: invalid encoding announcement, id={}", this->id, announced_id);
+		return false;
+	}
+	if (!counterpart_encodings_known)
+	{
+		on_counterpart_encodings(body[encodings_position]);
+	}
+	return true;
+}
+
+bool SocketWire::Base::is_compact_package(Buffer::ByteArray const& pkg)
+{
+	// package header, message length and id precede the context
+	constexpr size_t context_position = PACKAGE_HEADER_LENGTH + sizeof(int32_t) + sizeof(RdId::hash_t);
+	int16_t context = 0;
+	if (pkg.size() >= context_position + sizeof(context))
+	{
+		std::memcpy(&context, pkg.data() + context_position, sizeof(context));
+	}
+	return (context & COMPACT_ENCODING_CONTEXT) != 0;
+}
+
 void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_socket)
 {
 	{
@@ -136,10 +439,18 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 		}
 	}
 
-	auto heartbeat = LifetimeDefinition::use([this](Lifetime heartbeatLifetime) {
-		const auto heartbeat = start_heartbeat(heartbeatLifetime).share();
+	LifetimeDefinition::use([this](Lifetime heartbeatLifetime) {
+		// the counterpart may be another process now, both sides tell what they read before anything else
+		announce_encoding();
 
-		async_send_buffer.resume();
+		start_heartbeat(heartbeatLifetime);
+
+		// compact packages written for the previous counterpart wait for the first package of this one
+		sending_resumed = !async_send_buffer.any_unacknowledged(is_compact_package);
+		if (sending_resumed)
+		{
+			async_send_buffer.resume();
+		}
 
 		connected.set(true);
 
@@ -147,13 +458,13 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 
 		connected.set(false);
 
-		async_send_buffer.pause("Disconnected");
-
-		return heartbeat;
+		counterpart_reads_compact = false;
+		if (sending_resumed)
+		{
+			async_send_buffer.pause("Disconnected");
+		}
 	});
-	const auto status = heartbeat.wait_for(timeout);
-
-	logger->debug("{}: waited for heartbeat to stop with status: {}", this->id, status);
+	// terminating the heartbeat lifetime cancels the timer and waits for a ping in flight
 
 	if (!socket_provider->IsSocketValid())
 	{
@@ -171,15 +482,9 @@ bool SocketWire::Base::connection_established(int32_t timestamp, int32_t notion_
 	return timestamp - notion_timestamp <= MaximumHeartbeatDelay;
 }
 
-std::future<void> SocketWire::Base::start_heartbeat(Lifetime lifetime)
+void SocketWire::Base::start_heartbeat(Lifetime lifetime)
 {
-	return std::async([this, lifetime] {
-		while (!lifetime->is_terminated())
-		{
-			std::this_thread::sleep_for(heartBeatInterval);
-			ping();
-		}
-	});
+	TimerWheel::instance().schedule(lifetime, heartBeatInterval, heartBeatInterval, [this] { ping(); });
 }
 
 bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) const
@@ -195,18 +500,27 @@ bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) con
 		if (available > 0)
 		{
 			int32_t copylen = (std::min)(rest, available);
-			std::copy(lo, lo + copylen, res + ptr);
+			if (res != nullptr)
+			{
+				std::copy(lo, lo + copylen, res + ptr);
+			}
 			lo += copylen;
 			ptr += copylen;
 		}
 		else
 		{
-			if (hi == receiver_buffer.end())
+			if (hi == receiver_buffer.end() || lo == hi)
 			{
 				hi = lo = receiver_buffer.begin();
 			}
+			// everything received so far is processed, acknowledge it before blocking
+			flush_ack();
+
+			// large reads go straight to their destination instead of through receiver_buffer
+			const bool direct = res != nullptr && rest >= static_cast<int32_t>(RECEIVE_BUFFER_SIZE);
 			logger->info("{}: receive started", this->id);
-			int32_t read = socket_provider->Receive(static_cast<int32_t>(receiver_buffer.end() - hi), &*hi);
+			int32_t read = direct ? socket_provider->Receive(rest, res + ptr)
+								  : socket_provider->Receive(static_cast<int32_t>(receiver_buffer.end() - hi), &*hi);
 			if (read == -1)
 			{
 				auto err = socket_provider->GetSocketError();
@@ -223,7 +537,14 @@ bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) con
 				logger->info("{}: socket was shut down for receiving", this->id);
 				return false;
 			}
-			hi += read;
+			if (direct)
+			{
+				ptr += read;
+			}
+			else
+			{
+				hi += read;
+			}
 			if (read > 0)
 			{
 				logger->info("{}: receive finished: {} bytes read", this->id, read);
@@ -282,6 +603,10 @@ std::pair<int, sequence_number_t> SocketWire::Base::read_header() const
 				}
 				heartbeatAlive.set(true);
 			}
+			if (!counterpart_encodings_known)
+			{
+				on_counterpart_encodings(0);
+			}
 			continue;
 		}
 		if (!read_integral_from_socket(seqn))
@@ -289,6 +614,27 @@ std::pair<int, sequence_number_t> SocketWire::Base::read_header() const
 			return INVALID_HEADER;
 		}
 
+		if (seqn == ENCODING_ANNOUNCEMENT_SEQN)
+		{
+			if (len == ACK_MESSAGE_LENGTH)
+			{
+				// the counterpart has skipped our announcement, it doesn't announce anything itself
+				if (!counterpart_encodings_known)
+				{
+					on_counterpart_encodings(0);
+				}
+			}
+			else if (!read_encoding_announcement(len))
+			{
+				return INVALID_HEADER;
+			}
+			continue;
+		}
+		if (!counterpart_encodings_known)
+		{
+			on_counterpart_encodings(0);
+		}
+
 		if (len == ACK_MESSAGE_LENGTH)
 		{
 			async_send_buffer.acknowledge(seqn);
@@ -300,45 +646,54 @@ std::pair<int, sequence_number_t> SocketWire::Base::read_header() const
 
 int32_t SocketWire::Base::read_package() const
 {
-	receive_pkg.rewind();
-
-	const auto pair = read_header();
-	if (pair == INVALID_HEADER)
+	// previous package has been read completely
+	if (current_package_seqn != 0)
 	{
-		logger->debug("{}: failed to read header", this->id);
-		return -1;
+		queue_ack(current_package_seqn);
+		current_package_seqn = 0;
 	}
-	const auto len = pair.first;
-	const auto seqn = pair.second;
-
-	logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
 
-	receive_pkg.require_available(len);
-	if (!read_data_from_socket(receive_pkg.data(), len))
-	{
-		logger->debug("{}: failed to read package", this->id);
-		return -1;
-	}
-	send_ack(seqn);
-	if (seqn <= max_received_seqn && seqn != 1)
+	while (true)
 	{
-		return true;
-	}
-	max_received_seqn = seqn;
+		const auto pair = read_header();
+		if (pair == INVALID_HEADER)
+		{
+			logger->debug("{}: failed to read header", this->id);
+			return -1;
+		}
+		const auto len = pair.first;
+		const auto seqn = pair.second;
+
+		logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
 
-	logger->info("{}: was received package, bytes={}, seqn={}", this->id, len, seqn);
-	return len;
+		if (seqn <= max_received_seqn && seqn != 1)
+		{
+			// resent after a reconnect, already dispatched
+			if (!read_data_from_socket(nullptr, len))
+			{
+				logger->debug("{}: failed to skip package", this->id);
+				return -1;
+			}
+			queue_ack(seqn);
+			continue;
+		}
+		max_received_seqn = seqn;
+		current_package_seqn = seqn;
+
+		logger->info("{}: was received package, bytes={}, seqn={}", this->id, len, seqn);
+		return len;
+	}
 }
 
 bool SocketWire::Base::read_and_dispatch_message() const
 {
-	sz = (sz == -1 ? receive_pkg.read_integral<int32_t>() : sz);
+	const int32_t sz = receive_pkg.read_integral<int32_t>();
 	if (sz == -1)
 	{
 		logger->debug("{}: sz == -1", this->id);
 		return false;
 	}
-	id_ = (id_ == -1 ? receive_pkg.read_integral<RdId::hash_t>() : id_);
+	const RdId::hash_t id_ = receive_pkg.read_integral<RdId::hash_t>();
 	if (id_ == -1)
 	{
 		logger->error("id == -1");
@@ -346,24 +701,28 @@ bool SocketWire::Base::read_and_dispatch_message() const
 	}
 	logger->trace("{}: message info: sz={}, id={}", this->id, sz, id_);
 	const RdId rd_id{id_};
-	sz -= 8;	// RdId
-	message.require_available(sz);
+	const int32_t len = sz - 8;	   // RdId
 
-	if (!receive_pkg.read(message.data() + message.get_position(), sz - message.get_position()))
+	// the only copy of the message, it's owned by the scheduler of its entity until handled
+	Buffer message{static_cast<size_t>(len)};
+	if (!receive_pkg.read(message.data(), len))
 	{
 		logger->error("{}: constructing message failed", this->id);
 		return false;
 	}
 
+	const int16_t context = message.read_fixed_integral<int16_t>();
+	message.rewind();	 // context is skipped by the broker
+	if ((context & COMPACT_ENCODING_CONTEXT) != 0)
+	{
+		message.set_encoding(Buffer::Encoding::Compact);
+	}
+
 	logger->debug("{}: message received", this->id);
 	message_broker.dispatch(rd_id, std::move(message));
 	logger->debug("{}: message dispatched", this->id);
 
-	sz = -1;
-	id_ = -1;
-	message.rewind();
 	return true;
-	//		RD_ASSERT_MSG(summary_size == sz, "Broken message, read:%d bytes, expected:%d bytes", summary_size, sz)
 }
 
 CSimpleSocket* SocketWire::Base::get_socket_provider() const
@@ -392,7 +751,14 @@ void SocketWire::Base::ping() const
 		ping_pkg_header.write_integral(current_timestamp);
 		ping_pkg_header.write_integral(counterpart_timestamp);
 		{
-			std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+			// runs on the timer thread shared by all wires: rather than wait for a package being sent or for a counterpart
+			// which doesn't read, the tick is skipped
+			std::unique_lock<decltype(socket_send_lock)> guard(socket_send_lock, std::try_to_lock);
+			if (!guard.owns_lock() || !is_writable(*socket_provider))
+			{
+				logger->trace("{}: socket is busy, ping skipped", this->id);
+				return;
+			}
 			int32_t sent = socket_provider->Send(ping_pkg_header.data(), ping_pkg_header.get_position());
 			if (sent == 0 && !socket_provider->IsSocketValid())
 			{
@@ -427,6 +793,7 @@ bool SocketWire::Base::send_ack(sequence_number_t seqn) const
 					", reason: " +
 					socket_provider->DescribeError())
 		}
+		++acks_sent;
 		return true;
 	}
 	catch (std::exception const& e)
@@ -436,6 +803,58 @@ bool SocketWire::Base::send_ack(sequence_number_t seqn) const
 	}
 }
 
+void SocketWire::Base::queue_ack(sequence_number_t seqn) const
+{
+	++packages_received;
+
+	if (seqn == 1)
+	{
+		// counterpart has restarted its sequence
+		pending_ack_seqn = seqn;
+		sent_ack_seqn = 0;
+	}
+	else
+	{
+		pending_ack_seqn = (std::max)(pending_ack_seqn, seqn);
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (unacked_packages++ == 0)
+	{
+		first_unacked_time = now;
+	}
+	if (unacked_packages >= ackThreshold || now - first_unacked_time >= ackDelay)
+	{
+		flush_ack();
+	}
+}
+
+bool SocketWire::Base::flush_ack() const
+{
+	if (unacked_packages == 0)
+	{
+		return true;
+	}
+	unacked_packages = 0;
+	if (pending_ack_seqn == sent_ack_seqn)
+	{
+		// only duplicates since the last acknowledge
+		return true;
+	}
+	sent_ack_seqn = pending_ack_seqn;
+	return send_ack(pending_ack_seqn);
+}
+
+int64_t SocketWire::Base::get_packages_received() const
+{
+	return packages_received.load();
+}
+
+int64_t SocketWire::Base::get_acks_sent() const
+{
+	return acks_sent.load();
+}
+
 bool SocketWire::Base::try_shutdown_connection() const
 {
 	auto s = get_socket_provider();
@@ -446,7 +865,51 @@ bool SocketWire::Base::try_shutdown_connection() const
 }
 
 SocketWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
-	: Base(id, parentLifetime, scheduler), port(port), clientLifetimeDefinition(parentLifetime)
+	: Client(std::move(parentLifetime), scheduler, port, "", id)
+{
+}
+
+#ifdef RD_UNIX_DOMAIN_SOCKET
+SocketWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, std::string socket_path, const std::string& id)
+	: Client(std::move(parentLifetime), scheduler, 0, std::move(socket_path), id)
+{
+	RD_ASSERT_MSG(!this->socket_path.empty(), fmt::format("{}: socket path is empty", this->id));
+}
+#endif
+
+std::shared_ptr<CActiveSocket> SocketWire::Client::open_socket() const
+{
+#ifdef RD_UNIX_DOMAIN_SOCKET
+	if (!socket_path.empty())
+	{
+		auto unix_socket = std::make_shared<UnixActiveSocket>();
+		logger->info("{}: connecting {}", this->id, socket_path);
+		RD_ASSERT_THROW_MSG(unix_socket->Connect(socket_path),
+			fmt::format("{}: failed to connect to {}, reason: {}", this->id, socket_path, unix_socket->DescribeError()));
+		return unix_socket;
+	}
+#endif
+	auto tcp_socket = std::make_shared<CActiveSocket>();
+	RD_ASSERT_THROW_MSG(tcp_socket->Initialize(),
+		fmt::format("{}: failed to init ActiveSocket, reason: {}", this->id, tcp_socket->DescribeError()));
+	RD_ASSERT_THROW_MSG(tcp_socket->DisableNagleAlgoritm(),
+		fmt::format("{}: failed to DisableNagleAlgoritm, reason: {}", this->id, tcp_socket->DescribeError()));
+
+	// On windows connect will try to send SYN 3 times with interval of 500ms (total time is 1second)
+	// Connect timeout doesn't work if it's more than 1 second. But we don't need it because we can close socket any
+	// moment.
+
+	// https://stackoverflow.com/questions/22417228/prevent-tcp-socket-connection-retries
+	// HKLM\SYSTEM\CurrentControlSet\Services\Tcpip\Parameters\TcpMaxConnectRetransmissions
+	logger->info("{}: connecting 127.0.0.1: {}", this->id, this->port);
+	RD_ASSERT_THROW_MSG(tcp_socket->Open("127.0.0.1", this->port),
+		fmt::format("{}: failed to open ActiveSocket, reason: {}", this->id, tcp_socket->DescribeError()));
+	return tcp_socket;
+}
+
+SocketWire::Client::Client(
+	Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, std::string socket_path, const std::string& id)
+	: Base(id, parentLifetime, scheduler), port(port), socket_path(std::move(socket_path)), clientLifetimeDefinition(parentLifetime)
 {
 	Lifetime lifetime = clientLifetimeDefinition.lifetime;
 	thread = std::thread([this, lifetime]() mutable {
@@ -458,21 +921,7 @@ SocketWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, uint1
 			{
 				try
 				{
-					socket = std::make_shared<CActiveSocket>();
-					RD_ASSERT_THROW_MSG(socket->Initialize(),
-						fmt::format("{}: failed to init ActiveSocket, reason: {}", this->id, socket->DescribeError()));
-					RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
-						fmt::format("{}: failed to DisableNagleAlgoritm, reason: {}", this->id, socket->DescribeError()));
-
-					// On windows connect will try to send SYN 3 times with interval of 500ms (total time is 1second)
-					// Connect timeout doesn't work if it's more than 1 second. But we don't need it because we can close socket any
-					// moment.
-
-					// https://stackoverflow.com/questions/22417228/prevent-tcp-socket-connection-retries
-					// HKLM\SYSTEM\CurrentControlSet\Services\Tcpip\Parameters\TcpMaxConnectRetransmissions
-					logger->info("{}: connecting 127.0.0.1: {}", this->id, this->port);
-					RD_ASSERT_THROW_MSG(socket->Open("127.0.0.1", this->port),
-						fmt::format("{}: failed to open ActiveSocket, reason: {}", this->id, socket->DescribeError()));
+					socket = open_socket();
 					{
 						std::lock_guard<decltype(lock)> guard(lock);
 						if (lifetime->is_terminated())
@@ -548,19 +997,47 @@ SocketWire::Client::~Client()
 }
 
 SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
-	: Base(id, parentLifetime, scheduler), ss(std::make_unique<CPassiveSocket>()), serverLifetimeDefinition(parentLifetime)
+	: Server(std::move(parentLifetime), scheduler, port, "", id)
+{
+}
+
+#ifdef RD_UNIX_DOMAIN_SOCKET
+SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, std::string socket_path, const std::string& id)
+	: Server(std::move(parentLifetime), scheduler, 0, socket_path.empty() ? unique_socket_path() : std::move(socket_path), id)
+{
+}
+#endif
+
+SocketWire::Server::Server(
+	Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, std::string socket_path, const std::string& id)
+	: Base(id, parentLifetime, scheduler), socket_path(std::move(socket_path)), serverLifetimeDefinition(parentLifetime)
 {
 #ifdef SIGPIPE
 	signal(SIGPIPE, SIG_IGN);
 #endif
-	RD_ASSERT_MSG(ss->Initialize(), fmt::format("{}: failed to initialize socket, reason: {}", this->id, socket->DescribeError()));
-	RD_ASSERT_MSG(ss->Listen("127.0.0.1", port),
-		fmt::format("{}: failed to listen socket on port: {}, reason: {}", this->id, std::to_string(port), ss->DescribeError()));
+#ifdef RD_UNIX_DOMAIN_SOCKET
+	if (!this->socket_path.empty())
+	{
+		auto unix_socket = std::make_unique<UnixPassiveSocket>();
+		RD_ASSERT_MSG(unix_socket->Listen(this->socket_path),
+			fmt::format("{}: failed to listen socket {}, reason: {}", this->id, this->socket_path, unix_socket->DescribeError()));
+		ss = std::move(unix_socket);
 
-	this->port = ss->GetServerPort();
-	RD_ASSERT_MSG(this->port != 0, fmt::format("{}: port wasn't chosen", this->id));
+		logger->info("{}: listening {}", this->id, this->socket_path);
+	}
+	else
+#endif
+	{
+		ss = std::make_unique<CPassiveSocket>();
+		RD_ASSERT_MSG(ss->Initialize(), fmt::format("{}: failed to initialize socket, reason: {}", this->id, ss->DescribeError()));
+		RD_ASSERT_MSG(ss->Listen("127.0.0.1", port),
+			fmt::format("{}: failed to listen socket on port: {}, reason: {}", this->id, std::to_string(port), ss->DescribeError()));
 
-	logger->info("{}: listening 127.0.0.1/{}", this->id, this->port);
+		this->port = ss->GetServerPort();
+		RD_ASSERT_MSG(this->port != 0, fmt::format("{}: port wasn't chosen", this->id));
+
+		logger->info("{}: listening 127.0.0.1/{}", this->id, this->port);
+	}
 	Lifetime lifetime = serverLifetimeDefinition.lifetime;
 
 	thread = std::thread([this, lifetime]() mutable {
@@ -576,15 +1053,22 @@ SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint1
 				// winsock blocking accept hangs after creating new process with createprocess with inheritHandles=true
 				// property. Unreal Engine uses the same logic for handling sockets where they wait for timeout on select
 				// before trying to accept connection.
-				while(ss->IsSocketValid() && !ss->Select(0, 300)){}
+				while (ss->IsSocketValid() && !wait_for(*ss, POLLIN, 300)) {}
 				
 				CActiveSocket* accepted = ss->Accept();
 				RD_ASSERT_THROW_MSG(
 					accepted != nullptr, fmt::format("{}: accepting failed, reason: {}", this->id, ss->DescribeError()));
 				socket.reset(accepted);
-				logger->info("{}: accepted passive socket {}/{}", this->id, socket->GetClientAddr(), socket->GetClientPort());
-				RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
-					fmt::format("{}: tcpNoDelay failed, reason: {}", this->id, socket->DescribeError()));
+				if (this->socket_path.empty())
+				{
+					logger->info("{}: accepted passive socket {}/{}", this->id, socket->GetClientAddr(), socket->GetClientPort());
+					RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
+						fmt::format("{}: tcpNoDelay failed, reason: {}", this->id, socket->DescribeError()));
+				}
+				else
+				{
+					logger->info("{}: accepted passive socket {}", this->id, this->socket_path);
+				}
 
 				{
 					std::lock_guard<decltype(lock)> guard(lock);
@@ -621,6 +1105,12 @@ SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint1
 		{
 			logger->error("{}: failed to close server socket", this->id);
 		}
+#ifdef RD_UNIX_DOMAIN_SOCKET
+		if (!this->socket_path.empty() && !is_abstract_socket_path(this->socket_path))
+		{
+			::unlink(this->socket_path.c_str());
+		}
+#endif
 
 		{
 			std::lock_guard<decltype(lock)> guard(lock);
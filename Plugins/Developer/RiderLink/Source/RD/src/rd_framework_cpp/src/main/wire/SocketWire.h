@@ -6,6 +6,10 @@
 #pragma warning(disable:4251)
 #endif
 
+#if !defined(_WIN32)
+#define RD_UNIX_DOMAIN_SOCKET
+#endif
+
 #include "scheduler/base/IScheduler.h"
 #include "base/WireBase.h"
 #include "ByteBufferAsyncProcessor.h"
@@ -13,6 +17,8 @@
 
 #include <string>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 
 #include <rd_framework_export.h>
@@ -23,6 +29,11 @@ class CPassiveSocket;
 
 namespace rd
 {
+/**
+ * \brief Wire over a stream socket: TCP on 127.0.0.1, or where [RD_UNIX_DOMAIN_SOCKET] is defined a Unix domain socket
+ * which a client and a server select by a socket path instead of a port. A path starting with '@' names a socket in the
+ * Linux abstract namespace, any other path a socket file. Framing, heartbeat and reconnects don't depend on the transport.
+ */
 class RD_FRAMEWORK_API SocketWire
 {
 	static std::chrono::milliseconds timeout;
@@ -47,7 +58,7 @@ public:
 
 		mutable std::condition_variable socket_send_var;
 		mutable ByteBufferAsyncProcessor async_send_buffer{id + "-AsyncSendProcessor",
-			[this](Buffer::ByteArray const& it, sequence_number_t seqn) -> bool { return this->send0(it, seqn); }};
+			[this](Buffer::ByteArray& it, sequence_number_t seqn) -> bool { return this->send0(it, seqn); }};
 
 		static constexpr size_t RECEIVE_BUFFER_SIZE = 1u << 16;
 		mutable std::array<Buffer::word_t, RECEIVE_BUFFER_SIZE> receiver_buffer{};
@@ -56,6 +67,28 @@ public:
 		static constexpr int32_t ACK_MESSAGE_LENGTH = -1;
 		static constexpr int32_t PING_MESSAGE_LENGTH = -2;
 		static constexpr int32_t PACKAGE_HEADER_LENGTH = sizeof(ACK_MESSAGE_LENGTH) + sizeof(sequence_number_t);
+
+		/**
+		 * \brief Reserved id of the message announcing the encodings this side reads. It is written out of band as the
+		 * first package of every connection, with [ENCODING_ANNOUNCEMENT_SEQN] which an old counterpart takes for a
+		 * package it has already received: it skips it and acknowledges that seqn instead.
+		 * The bit of [Buffer::Encoding::Compact] is set in the context of every message written in it.
+		 */
+		static constexpr RdId::hash_t ENCODING_MESSAGE_ID = -2;
+		static constexpr sequence_number_t ENCODING_ANNOUNCEMENT_SEQN = 0;
+		static constexpr int16_t COMPACT_ENCODING_CONTEXT = 0x4000;
+
+		/**
+		 * \brief Whether the counterpart of the current connection has announced that it reads [Buffer::Encoding::Compact].
+		 */
+		mutable std::atomic<bool> counterpart_reads_compact{false};
+
+		/**
+		 * \brief Whether the first package of the counterpart has told what it reads. Until then packages written in the
+		 * compact encoding for a previous counterpart aren't sent again. Receiving thread only.
+		 */
+		mutable bool counterpart_encodings_known = false;
+		mutable bool sending_resumed = false;
 		mutable Buffer ack_buffer{PACKAGE_HEADER_LENGTH};
 
 		/**
@@ -76,15 +109,29 @@ public:
 		mutable Buffer ping_pkg_header{PACKAGE_HEADER_LENGTH};
 
 		mutable sequence_number_t max_received_seqn = 0;
-		mutable Buffer send_package_header{PACKAGE_HEADER_LENGTH};
 
-		static constexpr int32_t CHUNK_SIZE = 16370;
-		mutable int32_t sz = -1;
-		mutable RdId::hash_t id_ = -1;
-		mutable PkgInputStream receive_pkg{[this]() -> int32_t { return this->read_package(); }};
+		/**
+		 * \brief Highest received seqn which still has to be acknowledged, and the last one that was.
+		 */
+		mutable sequence_number_t pending_ack_seqn = 0;
+		mutable sequence_number_t sent_ack_seqn = 0;
+		mutable int32_t unacked_packages = 0;
+		mutable std::chrono::steady_clock::time_point first_unacked_time{};
 
-		mutable Buffer message{CHUNK_SIZE};
+		mutable std::atomic<int64_t> packages_received{0};
+		mutable std::atomic<int64_t> acks_sent{0};
 
+		/**
+		 * \brief Package being read by [receive_pkg], acknowledged once it has been read completely.
+		 */
+		mutable sequence_number_t current_package_seqn = 0;
+
+		mutable PkgInputStream receive_pkg{[this]() -> int32_t { return this->read_package(); },
+			[this](Buffer::word_t* res, size_t len) -> bool { return this->read_data_from_socket(res, len); }};
+
+		/**
+		 * \brief Copies [msglen] received bytes to [res], or skips them if [res] is null.
+		 */
 		bool read_from_socket(Buffer::word_t* res, int32_t msglen) const;
 
 		template <typename T>
@@ -106,6 +153,18 @@ public:
 		static constexpr int32_t MaximumHeartbeatDelay = 3;
 		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
 
+		/**
+		 * \brief Acknowledges are cumulative: one is sent when the socket has no more data to read,
+		 * after [ackThreshold] packages or when the oldest unacknowledged package is [ackDelay] old.
+		 */
+		int32_t ackThreshold = 32;
+		std::chrono::milliseconds ackDelay = std::chrono::milliseconds(10);
+
+		/**
+		 * \brief Messages are written in [Buffer::Encoding::Compact] once the counterpart has announced it reads it too.
+		 */
+		bool compactEncoding = true;
+
 		// region ctor/dtor
 
 		Base(std::string id, Lifetime lifetime, IScheduler* scheduler);
@@ -122,18 +181,44 @@ public:
 
 		void receiverProc() const;
 
-		bool send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const;
+		/**
+		 * \brief Sends [pkg] built by [send], its first [PACKAGE_HEADER_LENGTH] bytes are overwritten with the package header.
+		 */
+		bool send0(Buffer::ByteArray& pkg, sequence_number_t seqn) const;
 
 		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
 
+		/**
+		 * \brief Writes the announcement of the encodings this side reads straight to the socket, ahead of everything else.
+		 */
+		void announce_encoding() const;
+
+		/**
+		 * \brief Called for the first package of the counterpart: with its announcement or with no encodings if it
+		 * has sent anything else. Resumes sending, dropping the compact packages if the counterpart can't read them.
+		 */
+		void on_counterpart_encodings(uint8_t encodings) const;
+
+		bool read_encoding_announcement(int32_t len) const;
+
+		static bool is_compact_package(Buffer::ByteArray const& pkg);
+
 		static bool connection_established(int32_t timestamp, int32_t acknowledged_timestamp);
 
-		std::future<void> start_heartbeat(Lifetime lifetime);
+		void start_heartbeat(Lifetime lifetime);
 
 		void ping() const;
 
 		bool send_ack(sequence_number_t seqn) const;
 
+		void queue_ack(sequence_number_t seqn) const;
+
+		bool flush_ack() const;
+
+		int64_t get_packages_received() const;
+
+		int64_t get_acks_sent() const;
+
 		bool try_shutdown_connection() const;
 		
 	private:		
@@ -145,16 +230,29 @@ public:
 	public:
 		uint16_t port = 0;
 
+		/**
+		 * \brief Path of the Unix domain socket to connect to, empty when connecting over TCP to [port].
+		 */
+		std::string socket_path;
+
 		// region ctor/dtor
 
 		Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ClientSocket");
 
+#ifdef RD_UNIX_DOMAIN_SOCKET
+		Client(Lifetime parentLifetime, IScheduler* scheduler, std::string socket_path, const std::string& id = "ClientSocket");
+#endif
+
 		virtual ~Client() override;
 		// endregion
 
 		std::condition_variable_any cv;
 	private:		
 		LifetimeDefinition clientLifetimeDefinition;
+
+		Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, std::string socket_path, const std::string& id);
+
+		std::shared_ptr<CActiveSocket> open_socket() const;
 	};
 
 	class RD_FRAMEWORK_API Server : public Base
@@ -162,16 +260,31 @@ public:
 	public:
 		uint16_t port = 0;
 
+		/**
+		 * \brief Path of the Unix domain socket this server listens on, empty when it listens on TCP [port].
+		 */
+		std::string socket_path;
+
 		std::unique_ptr<CPassiveSocket> ss;
 
 		// region ctor/dtor
 
 		Server(Lifetime lifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ServerSocket");
 
+#ifdef RD_UNIX_DOMAIN_SOCKET
+		/**
+		 * \brief Listens on the Unix domain socket [socket_path], a stale socket file at the path is replaced. An empty path
+		 * picks a unique name in the abstract namespace on Linux and a socket file in the temporary directory elsewhere.
+		 */
+		Server(Lifetime lifetime, IScheduler* scheduler, std::string socket_path, const std::string& id = "ServerSocket");
+#endif
+
 		virtual ~Server() override;
 		// endregion
 	private:
 		LifetimeDefinition serverLifetimeDefinition;
+
+		Server(Lifetime lifetime, IScheduler* scheduler, uint16_t port, std::string socket_path, const std::string& id);
 	};
 };
 }	 // namespace rd
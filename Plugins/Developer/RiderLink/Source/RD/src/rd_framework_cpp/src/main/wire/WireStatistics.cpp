@@ -0,0 +1,258 @@
+#include "wire/WireStatistics.h"
+
+#include "spdlog/fmt/fmt.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace rd
+{
+constexpr size_t LatencyHistogram::BUCKETS;
+constexpr size_t WireStatistics::SHARDS;
+
+// region LatencyHistogram
+
+void LatencyHistogram::Snapshot::merge(Snapshot const& other)
+{
+	for (size_t i = 0; i < BUCKETS; ++i)
+	{
+		counts[i] += other.counts[i];
+	}
+	count += other.count;
+	total_ns += other.total_ns;
+	max_ns = (std::max)(max_ns, other.max_ns);
+}
+
+int64_t LatencyHistogram::Snapshot::percentile_us(double quantile) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+	const auto rank = static_cast<int64_t>(quantile * static_cast<double>(count - 1)) + 1;
+	int64_t seen = 0;
+	for (size_t i = 0; i < BUCKETS; ++i)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			return bucket_bound_us(i);
+		}
+	}
+	return bucket_bound_us(BUCKETS - 1);
+}
+
+double LatencyHistogram::Snapshot::mean_us() const
+{
+	return count == 0 ? 0.0 : static_cast<double>(total_ns) / static_cast<double>(count) / 1000.0;
+}
+
+size_t LatencyHistogram::bucket_of(std::chrono::nanoseconds latency)
+{
+	auto us = static_cast<uint64_t>((std::max)(latency.count(), int64_t{0}) / 1000);
+	// bit length of us, the bucket of 0 us is 0
+	size_t bucket = 0;
+	for (size_t shift = 32; shift > 0; shift /= 2)
+	{
+		if (us >= (uint64_t{1} << shift))
+		{
+			us >>= shift;
+			bucket += shift;
+		}
+	}
+	bucket += static_cast<size_t>(us);
+	return (std::min)(bucket, BUCKETS - 1);
+}
+
+int64_t LatencyHistogram::bucket_bound_us(size_t bucket)
+{
+	return bucket + 1 < BUCKETS ? int64_t{1} << bucket : int64_t{1} << (bucket - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency)
+{
+	const int64_t ns = latency.count();
+	counts[bucket_of(latency)].fetch_add(1, std::memory_order_relaxed);
+	total_ns.fetch_add(ns, std::memory_order_relaxed);
+	int64_t max = max_ns.load(std::memory_order_relaxed);
+	while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+	{
+	}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+	Snapshot result;
+	for (size_t i = 0; i < BUCKETS; ++i)
+	{
+		result.counts[i] = counts[i].load(std::memory_order_relaxed);
+		result.count += result.counts[i];
+	}
+	result.total_ns = total_ns.load(std::memory_order_relaxed);
+	result.max_ns = max_ns.load(std::memory_order_relaxed);
+	return result;
+}
+
+void LatencyHistogram::clear()
+{
+	for (auto& it : counts)
+	{
+		it.store(0, std::memory_order_relaxed);
+	}
+	total_ns.store(0, std::memory_order_relaxed);
+	max_ns.store(0, std::memory_order_relaxed);
+}
+
+// endregion
+
+// region WireStatistics
+
+WireStatistics::WireStatistics(std::function<std::string(RdId)> describe) : describe(std::move(describe))
+{
+}
+
+WireStatistics::Entry& WireStatistics::entry_of(RdId id)
+{
+	auto& s = shards[hash<RdId>()(id) % SHARDS];
+	std::lock_guard<decltype(s.lock)> guard(s.lock);
+	auto& entry = s.entries[id];
+	if (entry == nullptr)
+	{
+		entry = std::make_unique<Entry>();
+	}
+	return *entry;
+}
+
+void WireStatistics::on_sent(RdId id, size_t bytes)
+{
+	Entry& entry = entry_of(id);
+	entry.messages_sent.fetch_add(1, std::memory_order_relaxed);
+	entry.bytes_sent.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+WireStatistics::Receipt WireStatistics::on_received(RdId id, size_t bytes)
+{
+	Entry& entry = entry_of(id);
+	entry.messages_received.fetch_add(1, std::memory_order_relaxed);
+	entry.bytes_received.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+	return Receipt{&entry, clock::now()};
+}
+
+std::vector<WireStatistics::EntitySnapshot> WireStatistics::snapshot() const
+{
+	std::vector<EntitySnapshot> result;
+	for (auto& s : shards)
+	{
+		std::lock_guard<decltype(s.lock)> guard(s.lock);
+		for (auto const& it : s.entries)
+		{
+			Entry const& entry = *it.second;
+			EntitySnapshot item;
+			item.id = it.first;
+			item.messages_sent = entry.messages_sent.load(std::memory_order_relaxed);
+			item.bytes_sent = entry.bytes_sent.load(std::memory_order_relaxed);
+			item.messages_received = entry.messages_received.load(std::memory_order_relaxed);
+			item.bytes_received = entry.bytes_received.load(std::memory_order_relaxed);
+			item.queueing = entry.queueing.snapshot();
+			item.dispatch = entry.dispatch.snapshot();
+			result.push_back(std::move(item));
+		}
+	}
+	// locations are looked up outside of the shard locks, [describe] may take locks of its own
+	if (describe)
+	{
+		for (auto& item : result)
+		{
+			item.location = describe(item.id);
+		}
+	}
+	std::sort(result.begin(), result.end(), [](EntitySnapshot const& a, EntitySnapshot const& b) {
+		return a.bytes_sent + a.bytes_received > b.bytes_sent + b.bytes_received;
+	});
+	return result;
+}
+
+WireStatistics::EntitySnapshot WireStatistics::total() const
+{
+	EntitySnapshot result;
+	for (auto& s : shards)
+	{
+		std::lock_guard<decltype(s.lock)> guard(s.lock);
+		for (auto const& it : s.entries)
+		{
+			Entry const& entry = *it.second;
+			result.messages_sent += entry.messages_sent.load(std::memory_order_relaxed);
+			result.bytes_sent += entry.bytes_sent.load(std::memory_order_relaxed);
+			result.messages_received += entry.messages_received.load(std::memory_order_relaxed);
+			result.bytes_received += entry.bytes_received.load(std::memory_order_relaxed);
+			result.queueing.merge(entry.queueing.snapshot());
+			result.dispatch.merge(entry.dispatch.snapshot());
+		}
+	}
+	return result;
+}
+
+void WireStatistics::clear()
+{
+	// entries are kept, receipts of messages in flight point to them
+	for (auto& s : shards)
+	{
+		std::lock_guard<decltype(s.lock)> guard(s.lock);
+		for (auto const& it : s.entries)
+		{
+			Entry& entry = *it.second;
+			entry.messages_sent.store(0, std::memory_order_relaxed);
+			entry.bytes_sent.store(0, std::memory_order_relaxed);
+			entry.messages_received.store(0, std::memory_order_relaxed);
+			entry.bytes_received.store(0, std::memory_order_relaxed);
+			entry.queueing.clear();
+			entry.dispatch.clear();
+		}
+	}
+}
+
+std::string WireStatistics::dump() const
+{
+	const auto total_snapshot = total();
+	fmt::memory_buffer out;
+	fmt::format_to(out, "{:>20} {:>10} {:>12} {:>10} {:>12} {:>10} {:>10} {:>10} {:>10}  {}\n", "id", "sent", "sent bytes",
+		"received", "recv bytes", "queue p50", "queue p99", "disp p50", "disp p99", "location");
+	auto row = [&out](std::string const& id, EntitySnapshot const& it) {
+		fmt::format_to(out, "{:>20} {:>10} {:>12} {:>10} {:>12} {:>10} {:>10} {:>10} {:>10}  {}\n", id, it.messages_sent,
+			it.bytes_sent, it.messages_received, it.bytes_received, it.queueing.percentile_us(0.5), it.queueing.percentile_us(0.99),
+			it.dispatch.percentile_us(0.5), it.dispatch.percentile_us(0.99), it.location);
+	};
+	for (auto const& it : snapshot())
+	{
+		row(to_string(it.id), it);
+	}
+	row("total", total_snapshot);
+
+	fmt::format_to(out, "\n{:>12} {:>12} {:>12}\n", "below us", "queueing", "dispatch");
+	for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i)
+	{
+		if (total_snapshot.queueing.counts[i] == 0 && total_snapshot.dispatch.counts[i] == 0)
+		{
+			continue;
+		}
+		const std::string bound = i + 1 < LatencyHistogram::BUCKETS ? std::to_string(LatencyHistogram::bucket_bound_us(i)) : "inf";
+		fmt::format_to(out, "{:>12} {:>12} {:>12}\n", bound, total_snapshot.queueing.counts[i], total_snapshot.dispatch.counts[i]);
+	}
+	fmt::format_to(out, "{:>12} {:>12.1f} {:>12.1f}\n", "mean us", total_snapshot.queueing.mean_us(), total_snapshot.dispatch.mean_us());
+	fmt::format_to(out, "{:>12} {:>12} {:>12}\n", "max us", total_snapshot.queueing.max_ns / 1000, total_snapshot.dispatch.max_ns / 1000);
+	return fmt::to_string(out);
+}
+
+bool WireStatistics::dump_to_file(std::string const& path) const
+{
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+	file << dump();
+	return static_cast<bool>(file.flush());
+}
+
+// endregion
+}	 // namespace rd
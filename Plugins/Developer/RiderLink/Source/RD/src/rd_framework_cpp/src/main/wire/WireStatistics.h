@@ -0,0 +1,195 @@
+#ifndef RD_CPP_WIRESTATISTICS_H
+#define RD_CPP_WIRESTATISTICS_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "protocol/RdId.h"
+
+#include "std/unordered_map.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Counts latencies in fixed buckets of powers of two microseconds: bucket 0 holds latencies below 1 us,
+ * bucket i those from 2^(i-1) us up to 2^i us, and the last bucket everything longer. Recording is lock-free.
+ */
+class RD_FRAMEWORK_API LatencyHistogram
+{
+public:
+	static constexpr size_t BUCKETS = 24;
+
+	struct RD_FRAMEWORK_API Snapshot
+	{
+		std::array<int64_t, BUCKETS> counts{};
+		int64_t count = 0;
+		int64_t total_ns = 0;
+		int64_t max_ns = 0;
+
+		void merge(Snapshot const& other);
+
+		/**
+		 * \brief Upper bound in microseconds of the bucket which holds the [quantile] of the latencies, 0 if there are none.
+		 */
+		int64_t percentile_us(double quantile) const;
+
+		double mean_us() const;
+	};
+
+private:
+	std::array<std::atomic<int64_t>, BUCKETS> counts{};
+	std::atomic<int64_t> total_ns{0};
+	std::atomic<int64_t> max_ns{0};
+
+public:
+	static size_t bucket_of(std::chrono::nanoseconds latency);
+
+	/**
+	 * \brief Exclusive upper bound of [bucket] in microseconds, the last bucket is reported with its lower bound.
+	 */
+	static int64_t bucket_bound_us(size_t bucket);
+
+	void record(std::chrono::nanoseconds latency);
+
+	Snapshot snapshot() const;
+
+	void clear();
+};
+
+/**
+ * \brief Traffic of a wire per entity, collected while enabled by [WireBase::enable_statistics]:
+ * messages and bytes sent and received for every [RdId], how long a received message waits until its handler runs
+ * (queueing) and how long the handler takes (dispatch). Bytes are those of the message body including its context,
+ * without the id and the framing of the wire.
+ */
+class RD_FRAMEWORK_API WireStatistics
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * \brief Counters of one entity, they stay at the same address until the statistics are destroyed.
+	 */
+	struct Entry
+	{
+		std::atomic<int64_t> messages_sent{0};
+		std::atomic<int64_t> bytes_sent{0};
+		std::atomic<int64_t> messages_received{0};
+		std::atomic<int64_t> bytes_received{0};
+		LatencyHistogram queueing;
+		LatencyHistogram dispatch;
+	};
+
+	/**
+	 * \brief Handed with a received message to its handler, empty while statistics are disabled.
+	 */
+	struct Receipt
+	{
+		Entry* entry = nullptr;
+		clock::time_point received_at{};
+	};
+
+	struct RD_FRAMEWORK_API EntitySnapshot
+	{
+		RdId id;
+		std::string location;
+		int64_t messages_sent = 0;
+		int64_t bytes_sent = 0;
+		int64_t messages_received = 0;
+		int64_t bytes_received = 0;
+		LatencyHistogram::Snapshot queueing;
+		LatencyHistogram::Snapshot dispatch;
+	};
+
+private:
+	static constexpr size_t SHARDS = 16;
+
+	struct shard
+	{
+		std::mutex lock;
+		rd::unordered_map<RdId, std::unique_ptr<Entry>> entries;
+	};
+
+	mutable std::array<shard, SHARDS> shards;
+
+	std::function<std::string(RdId)> describe;
+
+public:
+	// region ctor/dtor
+
+	/**
+	 * \param describe gives the location of an entity in a snapshot, an empty string if it's unknown.
+	 */
+	explicit WireStatistics(std::function<std::string(RdId)> describe = {});
+
+	WireStatistics(WireStatistics const&) = delete;
+
+	WireStatistics& operator=(WireStatistics const&) = delete;
+
+	// endregion
+
+	Entry& entry_of(RdId id);
+
+	void on_sent(RdId id, size_t bytes);
+
+	Receipt on_received(RdId id, size_t bytes);
+
+	/**
+	 * \brief Runs the handler of a message received with [receipt] and records its latencies.
+	 */
+	template <typename F>
+	static void measure(Receipt const& receipt, F&& handler)
+	{
+		if (receipt.entry == nullptr)
+		{
+			handler();
+			return;
+		}
+		const auto started = clock::now();
+		receipt.entry->queueing.record(started - receipt.received_at);
+		handler();
+		receipt.entry->dispatch.record(clock::now() - started);
+	}
+
+	/**
+	 * \brief Entities ordered by the bytes they sent and received, most first.
+	 */
+	std::vector<EntitySnapshot> snapshot() const;
+
+	/**
+	 * \brief Sum of all entities, histograms included.
+	 */
+	EntitySnapshot total() const;
+
+	/**
+	 * \brief Resets all counters and histograms to zero.
+	 */
+	void clear();
+
+	/**
+	 * \brief Table of all entities followed by the buckets of the total histograms.
+	 */
+	std::string dump() const;
+
+	bool dump_to_file(std::string const& path) const;
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_WIRESTATISTICS_H
@@ -28,6 +28,17 @@
 
 #include "spdlog/sinks/daily_file_sink.h"
 
+static FString GetEnvironmentVariable(const FString& EnvironmentVarName)
+{
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 20
+    TCHAR Value[4096];
+    FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName, Value, ARRAY_COUNT(Value));
+    return Value;
+#else
+    return FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName);
+#endif
+}
+
 static FString GetLocalAppdataFolder()
 {
     const FString EnvironmentVarName =
@@ -36,13 +47,7 @@ TEXT("LOCALAPPDATA");
 #else
     TEXT("HOME");
 #endif
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 20
-    TCHAR CAppDataLocalPath[4096];
-    FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName, CAppDataLocalPath, ARRAY_COUNT(CAppDataLocalPath));
-    return CAppDataLocalPath;
-#else
-    return FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName);
-#endif
+    return GetEnvironmentVariable(EnvironmentVarName);
 }
 
 static FString GetMiscFilesFolder()
@@ -81,6 +86,15 @@ static FString GetLogFile()
 }
 
 
+ProtocolFactory::EWireTransport ProtocolFactory::GetWireTransport()
+{
+#ifdef RD_UNIX_DOMAIN_SOCKET
+    if (GetEnvironmentVariable(TEXT("RIDER_LINK_TRANSPORT")).Equals(TEXT("unix"), ESearchCase::IgnoreCase))
+        return EWireTransport::UnixDomainSocket;
+#endif
+    return EWireTransport::Tcp;
+}
+
 void ProtocolFactory::InitRdLogging()
 {
     spdlog::set_level(spdlog::level::err);
@@ -96,12 +110,19 @@ void ProtocolFactory::InitRdLogging()
 #endif
 }
 
-std::shared_ptr<rd::SocketWire::Server> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime)
+std::shared_ptr<rd::SocketWire::Server> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime,
+                                                                    EWireTransport Transport)
 {
     const FString ProjectName = GetProjectName();
-    return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0,
-                                                         TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"),
-                                                             *ProjectName)));
+    const std::string Id = TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"), *ProjectName));
+#ifdef RD_UNIX_DOMAIN_SOCKET
+    if (Transport == EWireTransport::UnixDomainSocket)
+    {
+        // an empty path picks a unique socket name
+        return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, std::string(), Id);
+    }
+#endif
+    return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0, Id);
 }
 
 
@@ -117,7 +138,11 @@ TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Schedul
     {
         const FString TmpPortFile = TEXT("~") + ProjectName;
         const FString TmpPortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *TmpPortFile);
-        FFileHelper::SaveStringToFile(FString::FromInt(wire->port), *TmpPortFileFullPath);
+        // a Unix domain socket is published as "unix:<path>" in place of the port
+        const FString Endpoint = wire->socket_path.empty()
+                                     ? FString::FromInt(wire->port)
+                                     : TEXT("unix:") + FString(UTF8_TO_TCHAR(wire->socket_path.c_str()));
+        FFileHelper::SaveStringToFile(Endpoint, *TmpPortFileFullPath);
         const FString PortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *ProjectName);
         IFileManager::Get().Move(*PortFileFullPath, *TmpPortFileFullPath, true, true);
     }
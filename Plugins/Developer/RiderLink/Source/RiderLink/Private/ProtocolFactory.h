@@ -6,7 +6,16 @@
 #include "Templates/UniquePtr.h"
 
 namespace ProtocolFactory {
+    // Unix domain sockets are available where rd defines RD_UNIX_DOMAIN_SOCKET, TCP is used elsewhere
+    enum class EWireTransport { Tcp, UnixDomainSocket };
+
+    // Transport selected by the RIDER_LINK_TRANSPORT environment variable: "unix" opts into a Unix domain socket,
+    // anything else keeps TCP. The port file under <misc files>/Ports/<Project>.uproject then holds "unix:<path>"
+    // instead of the port number; only clients that understand that form may opt in, Rider itself reads a port.
+    EWireTransport GetWireTransport();
+
     void InitRdLogging();
-    std::shared_ptr<rd::SocketWire::Server> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime);
+    std::shared_ptr<rd::SocketWire::Server> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime,
+                                                       EWireTransport Transport = EWireTransport::Tcp);
     TUniquePtr<rd::Protocol> CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::SocketWire::Server> wire);
 };
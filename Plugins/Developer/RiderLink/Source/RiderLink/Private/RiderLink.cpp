@@ -35,7 +35,7 @@ void FRiderLinkModule::InitProtocol()
 {
 	WireLifetimeDef = MakeUnique<rd::LifetimeDefinition>(ModuleLifetimeDef.lifetime);
 	rd::Lifetime WireLifetime = WireLifetimeDef->lifetime;
-	std::shared_ptr<rd::SocketWire::Server> Wire = ProtocolFactory::CreateWire(&Scheduler, WireLifetime);
+	std::shared_ptr<rd::SocketWire::Server> Wire = ProtocolFactory::CreateWire(&Scheduler, WireLifetime, ProtocolFactory::GetWireTransport());
 	Protocol = ProtocolFactory::CreateProtocol(&Scheduler, WireLifetime.create_nested(), Wire);
 	// Exception fired for Server::Base::~Base() when trying to invoke it this way
 //	WireLifetime->add_action([this]()
@@ -4,19 +4,110 @@
 #include "serialization/ArraySerializer.h"
 #include "Templates/UniquePtr.h"
 
+#include <cstring>
+
 //region FString
 
 namespace rd {
+    namespace {
+        // Strings travel as UTF-16 code units, copied straight between the buffer and the FString's own array.
+        // TCHAR shares that layout on most platforms, otherwise (UTF-32) the units are converted one by one.
+        template <int>
+        struct utf16_chars_spec {
+            static int32_t read(TCHAR* dst, const uint8_t* src, int32_t units) {
+                int32_t len = 0;
+                for (int32_t i = 0; i < units; ++i) {
+                    uint16_t unit;
+                    std::memcpy(&unit, src + sizeof(uint16_t) * i, sizeof(uint16_t));
+                    uint32_t code_point = unit;
+                    if (unit >= 0xD800 && unit < 0xDC00 && i + 1 < units) {
+                        uint16_t low;
+                        std::memcpy(&low, src + sizeof(uint16_t) * (i + 1), sizeof(uint16_t));
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                            ++i;
+                        }
+                    }
+                    dst[len++] = static_cast<TCHAR>(code_point);
+                }
+                return len;
+            }
+
+            static int32_t count_units(const TCHAR* src, int32_t len) {
+                int32_t units = len;
+                for (int32_t i = 0; i < len; ++i) {
+                    if (static_cast<uint32_t>(src[i]) > 0xFFFF) {
+                        ++units;
+                    }
+                }
+                return units;
+            }
+
+            static void write(uint8_t* dst, const TCHAR* src, int32_t len) {
+                for (int32_t i = 0; i < len; ++i) {
+                    const uint32_t code_point = static_cast<uint32_t>(src[i]);
+                    if (code_point > 0xFFFF) {
+                        const uint16_t pair[2] = {static_cast<uint16_t>(0xD800 + ((code_point - 0x10000) >> 10)),
+                                                  static_cast<uint16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF))};
+                        std::memcpy(dst, pair, sizeof(pair));
+                        dst += sizeof(pair);
+                    } else {
+                        const uint16_t unit = static_cast<uint16_t>(code_point);
+                        std::memcpy(dst, &unit, sizeof(unit));
+                        dst += sizeof(unit);
+                    }
+                }
+            }
+        };
+
+        template <>
+        struct utf16_chars_spec<2> {
+            static int32_t read(TCHAR* dst, const uint8_t* src, int32_t units) {
+                std::memcpy(dst, src, sizeof(uint16_t) * units);
+                return units;
+            }
+
+            static int32_t count_units(const TCHAR*, int32_t len) {
+                return len;
+            }
+
+            static void write(uint8_t* dst, const TCHAR* src, int32_t len) {
+                std::memcpy(dst, src, sizeof(uint16_t) * len);
+            }
+        };
+
+        using utf16_chars = utf16_chars_spec<sizeof(TCHAR)>;
+    }
 
     FString Polymorphic<FString, void>::read(SerializationCtx& ctx, Buffer& buffer) {
-        UCS2CHAR * str = buffer.read_char16_string();
-        FString tmp{str};
-        delete str;
-        return tmp;
+        const int32_t units = buffer.read_integral<int32_t>();
+        RD_ASSERT_THROW_MSG(units >= 0, "read null string(length =" + std::to_string(units) + ")")
+        FString result;
+        if (units == 0) {
+            return result;
+        }
+        const size_t bytes = sizeof(uint16_t) * units;
+        buffer.check_available(bytes);
+
+        TArray<TCHAR>& chars = result.GetCharArray();
+        chars.SetNumUninitialized(units + 1);
+        const int32_t len = utf16_chars::read(chars.GetData(), buffer.current_pointer(), units);
+        chars[len] = TEXT('\0');
+        if (len < units) {
+            chars.SetNum(len + 1, false);
+        }
+        buffer.set_position(buffer.get_position() + bytes);
+        return result;
     }
 
     void Polymorphic<FString, void>::write(SerializationCtx& ctx, Buffer& buffer, FString const& value) {
-        buffer.write_char16_string(reinterpret_cast<const uint16_t*>(GetData(value)), value.Len());
+        const int32_t len = value.Len();
+        const int32_t units = utf16_chars::count_units(GetData(value), len);
+        buffer.write_integral<int32_t>(units);
+        const size_t bytes = sizeof(uint16_t) * units;
+        buffer.require_available(bytes);
+        utf16_chars::write(buffer.current_pointer(), GetData(value), len);
+        buffer.set_position(buffer.get_position() + bytes);
     }
 
 
@@ -0,0 +1,209 @@
+#include "protocol/Buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace rd;
+
+// Buffer converts wide strings to the UTF-16 wire format eight characters at a time where SSE2 is available;
+// every case here is checked against a plain scalar conversion, with the interesting characters moved across
+// the 8-unit block boundaries and into the 0..7 unit tails.
+namespace
+{
+constexpr bool WIDE_IS_UTF32 = sizeof(wchar_t) == 4;
+
+std::vector<uint16_t> reference_encode(std::wstring const& value)
+{
+	std::vector<uint16_t> units;
+	for (wchar_t w : value)
+	{
+		const auto c = static_cast<uint32_t>(w);
+		if (!WIDE_IS_UTF32 || c <= 0xFFFF)
+		{
+			units.push_back(static_cast<uint16_t>(c));
+		}
+		else if (c > 0x10FFFF)
+		{
+			units.push_back(0xFFFD);
+		}
+		else
+		{
+			units.push_back(static_cast<uint16_t>(0xD800 + ((c - 0x10000) >> 10)));
+			units.push_back(static_cast<uint16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+		}
+	}
+	return units;
+}
+
+std::wstring reference_decode(std::vector<uint16_t> const& units)
+{
+	std::wstring value;
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		const uint32_t unit = units[i];
+		if (WIDE_IS_UTF32 && unit >= 0xD800 && unit < 0xDC00 && i + 1 < units.size() && units[i + 1] >= 0xDC00 &&
+			units[i + 1] < 0xE000)
+		{
+			value.push_back(static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (units[i + 1] - 0xDC00)));
+			++i;
+		}
+		else
+		{
+			value.push_back(static_cast<wchar_t>(unit));
+		}
+	}
+	return value;
+}
+
+Buffer::ByteArray written_bytes(Buffer& buffer)
+{
+	auto const& data = buffer.get_data();
+	return Buffer::ByteArray(data.begin(), data.begin() + buffer.get_position());
+}
+
+Buffer::ByteArray encode(std::wstring const& value)
+{
+	Buffer buffer;
+	buffer.write_wstring(value);
+	return written_bytes(buffer);
+}
+
+Buffer::ByteArray encode_units(std::vector<uint16_t> const& units)
+{
+	Buffer buffer;
+	buffer.write_char16_string(units.data(), units.size());
+	return written_bytes(buffer);
+}
+
+std::wstring decode_units(std::vector<uint16_t> const& units)
+{
+	Buffer buffer(encode_units(units));
+	return buffer.read_wstring();
+}
+
+void expect_matches_reference(std::wstring const& value)
+{
+	auto const units = reference_encode(value);
+	EXPECT_EQ(encode(value), encode_units(units));
+	EXPECT_EQ(decode_units(units), reference_decode(units));
+}
+
+std::wstring filled(size_t length, wchar_t filler)
+{
+	return std::wstring(length, filler);
+}
+}	 // namespace
+
+TEST(BufferWStringTest, TailLengths)
+{
+	// up to three full blocks followed by every tail length
+	for (wchar_t filler : {L'a', static_cast<wchar_t>(0x00E9), static_cast<wchar_t>(0x4E2D), static_cast<wchar_t>(0xFFFF)})
+	{
+		for (size_t length = 0; length <= 3 * 8 + 7; ++length)
+		{
+			SCOPED_TRACE("filler " + std::to_string(filler) + ", length " + std::to_string(length));
+			expect_matches_reference(filled(length, filler));
+		}
+	}
+}
+
+TEST(BufferWStringTest, NonAsciiBmpCharacters)
+{
+	// 0x8000 and above have the sign bit set in a 16-bit lane, which the vector pack must not saturate
+	const std::vector<uint32_t> characters = {0x7F, 0x80, 0xFF, 0x100, 0x7FFF, 0x8000, 0xABCD, 0xD7FF, 0xE000, 0xFFFE, 0xFFFF};
+	std::wstring mixed;
+	for (size_t i = 0; i < 40; ++i)
+	{
+		mixed.push_back(static_cast<wchar_t>(characters[i % characters.size()]));
+	}
+	for (size_t length = 0; length <= mixed.size(); ++length)
+	{
+		SCOPED_TRACE("length " + std::to_string(length));
+		expect_matches_reference(mixed.substr(0, length));
+	}
+}
+
+TEST(BufferWStringTest, SurrogatePairsAcrossBlockBoundaries)
+{
+	// place the pair (or the supplementary character) at every position of three blocks, so it starts in the
+	// last unit of a block and ends in the first of the next one at positions 7, 15 and 23
+	for (size_t position = 0; position < 3 * 8; ++position)
+	{
+		SCOPED_TRACE("position " + std::to_string(position));
+
+		std::vector<uint16_t> units(3 * 8 + 3, 'x');
+		units[position] = 0xD83D;
+		units[position + 1] = 0xDE00;
+		EXPECT_EQ(decode_units(units), reference_decode(units));
+		EXPECT_EQ(encode(decode_units(units)), encode_units(units));
+
+		if (WIDE_IS_UTF32)
+		{
+			std::wstring value = filled(3 * 8 + 2, L'x');
+			value[position] = static_cast<wchar_t>(0x1F600);
+			expect_matches_reference(value);
+		}
+	}
+	// a pair as the very last two units, with nothing after it
+	for (size_t length = 2; length <= 2 * 8 + 1; ++length)
+	{
+		SCOPED_TRACE("trailing pair, length " + std::to_string(length));
+		std::vector<uint16_t> units(length, 'x');
+		units[length - 2] = 0xDBFF;
+		units[length - 1] = 0xDFFF;
+		EXPECT_EQ(decode_units(units), reference_decode(units));
+	}
+}
+
+TEST(BufferWStringTest, LoneSurrogates)
+{
+	struct lone
+	{
+		const char* name;
+		std::vector<uint16_t> sequence;
+	};
+	const std::vector<lone> cases = {
+		{"high", {0xD800}},
+		{"low", {0xDC00}},
+		{"high high", {0xDBFF, 0xD800}},
+		{"low high", {0xDFFF, 0xD800}},
+		{"high non-surrogate", {0xD800, 0x0041}},
+	};
+	for (auto const& c : cases)
+	{
+		for (size_t position = 0; position + c.sequence.size() <= 3 * 8; ++position)
+		{
+			SCOPED_TRACE(std::string(c.name) + " at " + std::to_string(position));
+
+			std::vector<uint16_t> units(3 * 8, 'y');
+			std::copy(c.sequence.begin(), c.sequence.end(), units.begin() + position);
+			// ends with the lone unit as the last one of the string as well
+			for (size_t length : {position + c.sequence.size(), units.size()})
+			{
+				std::vector<uint16_t> prefix(units.begin(), units.begin() + length);
+				auto const decoded = decode_units(prefix);
+				EXPECT_EQ(decoded, reference_decode(prefix));
+				// unpaired surrogates pass through unchanged, so the counterpart's string survives a round trip
+				EXPECT_EQ(encode(decoded), encode_units(prefix));
+			}
+		}
+	}
+}
+
+TEST(BufferWStringTest, CharactersBeyondUnicodeBecomeReplacementCharacter)
+{
+	if (!WIDE_IS_UTF32)
+	{
+		GTEST_SKIP() << "wchar_t can't hold characters beyond U+FFFF";
+	}
+	for (size_t position = 0; position < 2 * 8; ++position)
+	{
+		SCOPED_TRACE("position " + std::to_string(position));
+		std::wstring value = filled(2 * 8 + 3, L'z');
+		value[position] = static_cast<wchar_t>(0x110000);
+		expect_matches_reference(value);
+	}
+}
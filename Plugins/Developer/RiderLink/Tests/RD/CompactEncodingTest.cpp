@@ -0,0 +1,220 @@
+#include "wire/SocketWire.h"
+#include "wire/EventLoopSocketWire.h"
+#include "scheduler/SingleThreadScheduler.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <ActiveSocket.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+
+namespace
+{
+using Bytes = std::vector<uint8_t>;
+
+// captured from the wire: [int32 len][int64 seqn] package header, then [int32 msglen][int64 id][int16 context][payload]
+
+const Bytes ANNOUNCEMENT_READS_COMPACT = {0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0x00,
+	0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x02};
+
+const Bytes ACK_OF_ANNOUNCEMENT = {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// int32 42 sent to id 1 as the first package, in the fixed and in the compact encoding
+const Bytes FIXED_MESSAGE = {0x12, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00,
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00};
+
+const Bytes COMPACT_MESSAGE = {0x0F, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0x00, 0x00,
+	0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x54};
+
+bool wait_until(std::function<bool()> const& condition, std::chrono::milliseconds timeout = std::chrono::seconds(30))
+{
+	auto const deadline = std::chrono::steady_clock::now() + timeout;
+	while (!condition())
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	return true;
+}
+
+/**
+ * \brief Counterpart which speaks the package framing by hand, so that the test sees the bytes a wire writes.
+ */
+class RawPeer
+{
+	CActiveSocket socket;
+
+	bool read_exactly(uint8_t* data, int32_t size)
+	{
+		while (size > 0)
+		{
+			const int32_t read = socket.Receive(size, data);
+			if (read <= 0)
+				return false;
+			data += read;
+			size -= read;
+		}
+		return true;
+	}
+
+public:
+	explicit RawPeer(uint16_t port)
+	{
+		socket.Initialize();
+		socket.DisableNagleAlgoritm();
+		socket.SetReceiveTimeout(5);
+		EXPECT_TRUE(socket.Open("127.0.0.1", port));
+	}
+
+	~RawPeer()
+	{
+		socket.Close();
+	}
+
+	void send(Bytes const& bytes)
+	{
+		EXPECT_EQ(static_cast<int32_t>(bytes.size()), socket.Send(bytes.data(), bytes.size()));
+	}
+
+	/**
+	 * \brief Next package with a body, pings and acknowledges are skipped. Empty if nothing comes in time.
+	 */
+	Bytes next_package()
+	{
+		while (true)
+		{
+			Bytes header(12);
+			if (!read_exactly(header.data(), 12))
+				return {};
+			int32_t len;
+			std::memcpy(&len, header.data(), sizeof(len));
+			if (len < 0)
+				continue;
+			header.resize(12 + static_cast<size_t>(len));
+			if (!read_exactly(header.data() + 12, len))
+				return {};
+			return header;
+		}
+	}
+};
+
+template <typename W>
+class ProbedServer : public W::Server
+{
+public:
+	using W::Server::Server;
+
+	bool reads_compact() const
+	{
+		return this->counterpart_reads_compact;
+	}
+};
+
+/**
+ * \brief A server wire of either implementation and raw counterparts connecting to it one after another.
+ */
+template <typename W>
+class CompactEncodingTest : public ::testing::Test
+{
+protected:
+	LifetimeDefinition definition{false};
+	Lifetime lifetime = definition.lifetime;
+	SingleThreadScheduler scheduler{lifetime, "WireScheduler"};
+	std::shared_ptr<ProbedServer<W>> wire;
+
+	void SetUp() override
+	{
+		spdlog::set_level(spdlog::level::err);
+		wire = std::make_shared<ProbedServer<W>>(lifetime, &scheduler, 0, "TestServer");
+	}
+
+	void TearDown() override
+	{
+		definition.terminate();
+	}
+
+	void send_answer() const
+	{
+		wire->send(RdId{1}, [](Buffer& buffer) { buffer.write_integral<int32_t>(42); });
+	}
+
+	std::unique_ptr<RawPeer> connect_old_peer()
+	{
+		auto peer = std::make_unique<RawPeer>(wire->port);
+		EXPECT_EQ(ANNOUNCEMENT_READS_COMPACT, peer->next_package());
+		// an old counterpart takes the announcement for a duplicate, it skips it and acknowledges it
+		peer->send(ACK_OF_ANNOUNCEMENT);
+		return peer;
+	}
+
+	std::unique_ptr<RawPeer> connect_compact_peer()
+	{
+		auto peer = std::make_unique<RawPeer>(wire->port);
+		EXPECT_EQ(ANNOUNCEMENT_READS_COMPACT, peer->next_package());
+		peer->send(ANNOUNCEMENT_READS_COMPACT);
+		EXPECT_TRUE(wait_until([this] { return wire->reads_compact(); }));
+		return peer;
+	}
+
+	void disconnect(std::unique_ptr<RawPeer>& peer)
+	{
+		peer.reset();
+		EXPECT_TRUE(wait_until([this] { return !wire->connected.get(); }));
+	}
+};
+
+#ifdef RD_SOCKET_EVENT_LOOP
+using Wires = ::testing::Types<SocketWire, EventLoopSocketWire>;
+#else
+using Wires = ::testing::Types<SocketWire>;
+#endif
+TYPED_TEST_SUITE(CompactEncodingTest, Wires);
+}	 // namespace
+
+TYPED_TEST(CompactEncodingTest, OldCounterpartGetsFixedEncoding)
+{
+	auto peer = this->connect_old_peer();
+	this->send_answer();
+	EXPECT_EQ(FIXED_MESSAGE, peer->next_package());
+}
+
+TYPED_TEST(CompactEncodingTest, CompactCounterpartGetsCompactEncoding)
+{
+	auto peer = this->connect_compact_peer();
+	this->send_answer();
+	EXPECT_EQ(COMPACT_MESSAGE, peer->next_package());
+}
+
+TYPED_TEST(CompactEncodingTest, CompactPackagesArentResentToOldCounterpart)
+{
+	auto compact_peer = this->connect_compact_peer();
+	this->send_answer();
+	EXPECT_EQ(COMPACT_MESSAGE, compact_peer->next_package());
+	// gone without acknowledging it
+	this->disconnect(compact_peer);
+
+	auto old_peer = this->connect_old_peer();
+	this->send_answer();
+	// the compact package is dropped, the next one takes its seqn
+	EXPECT_EQ(FIXED_MESSAGE, old_peer->next_package());
+}
+
+TYPED_TEST(CompactEncodingTest, CompactPackagesAreResentToCompactCounterpart)
+{
+	auto first_peer = this->connect_compact_peer();
+	this->send_answer();
+	EXPECT_EQ(COMPACT_MESSAGE, first_peer->next_package());
+	this->disconnect(first_peer);
+
+	auto second_peer = this->connect_compact_peer();
+	EXPECT_EQ(COMPACT_MESSAGE, second_peer->next_package());
+}
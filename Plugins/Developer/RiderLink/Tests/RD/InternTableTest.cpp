@@ -0,0 +1,153 @@
+#include "intern/InternTable.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+
+namespace
+{
+std::vector<InternedAny> make_values(int count)
+{
+	std::vector<InternedAny> values;
+	values.reserve(count);
+	for (int i = 0; i < count; ++i)
+	{
+		values.emplace_back(any::string(L"value_" + std::to_wstring(i)));
+	}
+	return values;
+}
+}	 // namespace
+
+TEST(InternTableTest, ConcurrentInternUnInternAndLookup)
+{
+	constexpr int count = 100000;
+	constexpr int lookup_threads = 3;
+	constexpr int un_intern_threads = 2;
+
+	auto const values = make_values(count);
+	InternTable table;
+	// InternRoot serializes writers with its lock, readers don't take it
+	std::mutex write_lock;
+	std::vector<int32_t> ids(count, InternTable::NOT_INTERNED);
+	std::atomic<int> published{0};
+	std::atomic<int> mismatches{0};
+
+	std::thread own_writer([&] {
+		for (int i = 0; i < count; i += 2)
+		{
+			std::lock_guard<std::mutex> guard(write_lock);
+			ids[i] = table.add_own(values[i]);
+		}
+	});
+	// the counterpart's values arrive with odd ids chosen by the other side
+	std::thread counterpart_writer([&] {
+		for (int i = 1; i < count; i += 2)
+		{
+			std::lock_guard<std::mutex> guard(write_lock);
+			ids[i] = i;
+			table.set(i, values[i]);
+		}
+	});
+	std::thread publisher([&] {
+		own_writer.join();
+		counterpart_writer.join();
+		published.store(count);
+	});
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < lookup_threads; ++r)
+	{
+		readers.emplace_back([&, r] {
+			unsigned seed = 7919u * (r + 1);
+			while (published.load() < count)
+			{
+				seed = seed * 1103515245u + 12345u;
+				auto const& value = values[seed % count];
+				const int32_t id = table.find(value);
+				if (id == InternTable::NOT_INTERNED)
+				{
+					continue;
+				}
+				InternedAny const* found = table.get(id);
+				if (found == nullptr || !(*found == value))
+				{
+					++mismatches;
+				}
+			}
+		});
+	}
+	for (int r = 0; r < un_intern_threads; ++r)
+	{
+		readers.emplace_back([&, r] {
+			unsigned seed = 104729u * (r + 1);
+			while (published.load() < count)
+			{
+				seed = seed * 1103515245u + 12345u;
+				const int32_t id = static_cast<int32_t>(seed % count);
+				InternedAny const* found = table.get(id);
+				// own values are added in the order of even indices, so both sides end up with id == index
+				if (found != nullptr && !(*found == values[id]))
+				{
+					++mismatches;
+				}
+			}
+		});
+	}
+
+	publisher.join();
+	for (auto& t : readers)
+	{
+		t.join();
+	}
+
+	EXPECT_EQ(mismatches.load(), 0);
+	for (int i = 0; i < count; ++i)
+	{
+		ASSERT_EQ(ids[i], i);
+		ASSERT_EQ(table.find(values[i]), i) << "value " << i;
+		ASSERT_NE(table.get(ids[i]), nullptr);
+		ASSERT_TRUE(*table.get(ids[i]) == values[i]);
+	}
+}
+
+TEST(InternTableTest, RetiredIndexTablesAreReclaimed)
+{
+	constexpr int count = 50000;
+
+	auto const values = make_values(count + 1);
+	InternTable table;
+	std::atomic<bool> done{false};
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 4; ++r)
+	{
+		readers.emplace_back([&, r] {
+			unsigned seed = 31u * (r + 1);
+			while (!done.load())
+			{
+				seed = seed * 1103515245u + 12345u;
+				table.find(values[seed % count]);
+			}
+		});
+	}
+	for (int i = 0; i < count; ++i)
+	{
+		table.add_own(values[i]);
+	}
+	done = true;
+	for (auto& t : readers)
+	{
+		t.join();
+	}
+
+	// with no reader left the next write frees whatever the growths above retired
+	table.add_own(values[count]);
+	EXPECT_EQ(table.index_tables_alive(), 1u);
+	EXPECT_EQ(table.find(values[count]), 2 * count);
+}
@@ -0,0 +1,160 @@
+#include "protocol/MessageBroker.h"
+#include "scheduler/SynchronousScheduler.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+
+/**
+ * Contention benchmark of MessageBroker, not run by ctest: binds many entities, then measures the latency of
+ * dispatch while several threads keep subscribing and unsubscribing other entities.
+ *
+ *   rd_message_broker_benchmark [bound entities] [subscribing threads] [messages]
+ */
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+class BenchmarkEntity final : public IRdReactive
+{
+public:
+	mutable std::atomic<int64_t> received{0};
+
+	explicit BenchmarkEntity(int64_t id)
+	{
+		rdid = RdId{id};
+	}
+
+	void bind(Lifetime, IRdDynamic const*, string_view) const override
+	{
+	}
+
+	void identify(Identities const&, RdId const&) const override
+	{
+	}
+
+	const IProtocol* get_protocol() const override
+	{
+		return nullptr;
+	}
+
+	SerializationCtx& get_serialization_context() const override
+	{
+		throw std::logic_error("not serialized");
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return &SynchronousScheduler::Instance();
+	}
+
+	void on_wire_received(Buffer) const override
+	{
+		++received;
+	}
+};
+
+void on_default_scheduler(std::function<void()> action)
+{
+	// subscriptions are changed on the default scheduler
+	SynchronousScheduler::Instance().queue(std::move(action));
+}
+
+Buffer make_message()
+{
+	Buffer message;
+	message.write_fixed_integral<int16_t>(0);	 // context
+	message.write_fixed_integral<int32_t>(42);
+	message.rewind();
+	return message;
+}
+
+double percentile(std::vector<int64_t>& sorted, double p)
+{
+	return static_cast<double>(sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))]);
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	const int bound = argc > 1 ? std::atoi(argv[1]) : 20000;
+	const int subscribers = argc > 2 ? std::atoi(argv[2]) : 4;
+	const int messages = argc > 3 ? std::atoi(argv[3]) : 1000000;
+
+	spdlog::set_level(spdlog::level::err);
+	MessageBroker broker(&SynchronousScheduler::Instance());
+	LifetimeDefinition definition{false};
+
+	std::vector<std::unique_ptr<BenchmarkEntity>> entities;
+	entities.reserve(bound);
+	for (int i = 0; i < bound; ++i)
+	{
+		entities.push_back(std::make_unique<BenchmarkEntity>(i + 1));
+	}
+	const auto bind_start = clock_type::now();
+	on_default_scheduler([&] {
+		for (auto const& entity : entities)
+		{
+			broker.advise_on(definition.lifetime, entity.get());
+		}
+	});
+	const auto bind_time = std::chrono::duration<double, std::milli>(clock_type::now() - bind_start).count();
+	std::printf("bound %d entities in %.1f ms (%.2f us per advise)\n", bound, bind_time, bind_time * 1000 / bound);
+
+	std::atomic<bool> stop{false};
+	std::atomic<int64_t> churns{0};
+	std::vector<std::thread> threads;
+	for (int t = 0; t < subscribers; ++t)
+	{
+		threads.emplace_back([&, t] {
+			// each thread churns its own ids above the bound ones
+			BenchmarkEntity entity(int64_t{bound} + 1 + t);
+			while (!stop)
+			{
+				LifetimeDefinition subscription{definition.lifetime};
+				on_default_scheduler([&] { broker.advise_on(subscription.lifetime, &entity); });
+				subscription.terminate();
+				++churns;
+			}
+		});
+	}
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> pick(0, bound - 1);
+	std::vector<int64_t> latencies;
+	latencies.reserve(messages);
+	const auto dispatch_start = clock_type::now();
+	for (int i = 0; i < messages; ++i)
+	{
+		const RdId id{pick(random) + 1};
+		Buffer message = make_message();
+		const auto start = clock_type::now();
+		broker.dispatch(id, std::move(message));
+		latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+	}
+	const auto dispatch_time = std::chrono::duration<double>(clock_type::now() - dispatch_start).count();
+	stop = true;
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	std::printf("%d dispatches with %d subscribing threads (%lld subscriptions changed), %.0f messages/s\n", messages,
+		subscribers, static_cast<long long>(churns.load()), messages / dispatch_time);
+	std::printf("dispatch latency ns: p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n", percentile(latencies, 0.5),
+		percentile(latencies, 0.9), percentile(latencies, 0.99), percentile(latencies, 0.999),
+		static_cast<double>(latencies.back()));
+
+	definition.terminate();
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "protocol/MessageBroker.h"
+#include "scheduler/SynchronousScheduler.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace rd;
+
+namespace
+{
+/**
+ * \brief Out of order scheduler which runs everything at once and counts how it was queued.
+ */
+class RecordingScheduler : public IScheduler
+{
+public:
+	int queued = 0;
+	int queued_ordered = 0;
+
+	RecordingScheduler()
+	{
+		out_of_order_execution = true;
+	}
+
+	void queue(std::function<void()> action) override
+	{
+		++queued;
+		action();
+	}
+
+	void queue_ordered(size_t /*key*/, std::function<void()> action) override
+	{
+		++queued_ordered;
+		action();
+	}
+
+	void flush() override
+	{
+	}
+
+	bool is_active() const override
+	{
+		return true;
+	}
+};
+
+class TestEntity final : public IRdReactive
+{
+	IScheduler* wire_scheduler;
+
+public:
+	mutable int received = 0;
+
+	TestEntity(int64_t id, IScheduler* wire_scheduler) : wire_scheduler(wire_scheduler)
+	{
+		rdid = RdId{id};
+	}
+
+	void bind(Lifetime, IRdDynamic const*, string_view) const override
+	{
+	}
+
+	void identify(Identities const&, RdId const&) const override
+	{
+	}
+
+	const IProtocol* get_protocol() const override
+	{
+		return nullptr;
+	}
+
+	SerializationCtx& get_serialization_context() const override
+	{
+		throw std::logic_error("not serialized");
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return wire_scheduler;
+	}
+
+	void on_wire_received(Buffer) const override
+	{
+		++received;
+	}
+};
+
+Buffer make_message()
+{
+	Buffer message;
+	message.write_fixed_integral<int16_t>(0);	 // context
+	message.rewind();
+	return message;
+}
+}	 // namespace
+
+TEST(MessageBrokerTest, OnlyOrderedEntitiesAreQueuedInOrder)
+{
+	LifetimeDefinition definition{false};
+	MessageBroker broker(&SynchronousScheduler::Instance());
+	RecordingScheduler wire_scheduler;
+
+	TestEntity ordered(1, &wire_scheduler);
+	TestEntity unordered(2, &wire_scheduler);
+	unordered.ordered = false;
+	SynchronousScheduler::Instance().queue([&] {
+		broker.advise_on(definition.lifetime, &ordered);
+		broker.advise_on(definition.lifetime, &unordered);
+	});
+
+	for (int i = 0; i < 3; ++i)
+	{
+		broker.dispatch(ordered.rdid, make_message());
+	}
+	EXPECT_EQ(3, wire_scheduler.queued_ordered);
+	EXPECT_EQ(0, wire_scheduler.queued);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		broker.dispatch(unordered.rdid, make_message());
+	}
+	EXPECT_EQ(3, wire_scheduler.queued_ordered);
+	EXPECT_EQ(2, wire_scheduler.queued);
+
+	EXPECT_EQ(3, ordered.received);
+	EXPECT_EQ(2, unordered.received);
+	definition.terminate();
+}
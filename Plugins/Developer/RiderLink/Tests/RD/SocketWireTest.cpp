@@ -0,0 +1,261 @@
+#include "wire/SocketWire.h"
+#include "protocol/Protocol.h"
+#include "protocol/Identities.h"
+#include "scheduler/SingleThreadScheduler.h"
+#include "impl/RdSignal.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+
+namespace
+{
+enum class Transport
+{
+	Tcp,
+	UnixDomainSocket
+};
+
+bool wait_until(std::function<bool()> const& condition, std::chrono::milliseconds timeout = std::chrono::seconds(30))
+{
+	auto const deadline = std::chrono::steady_clock::now() + timeout;
+	while (!condition())
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	return true;
+}
+
+/**
+ * \brief Connected server/client pair of SocketWire with a protocol on each side, parametrized by the transport.
+ */
+class SocketWireTest : public ::testing::TestWithParam<Transport>
+{
+protected:
+	LifetimeDefinition definition{false};
+	Lifetime lifetime = definition.lifetime;
+
+	SingleThreadScheduler server_scheduler{lifetime, "ServerScheduler"};
+	SingleThreadScheduler client_scheduler{lifetime, "ClientScheduler"};
+
+	std::shared_ptr<SocketWire::Server> server_wire;
+	std::shared_ptr<SocketWire::Client> client_wire;
+
+	std::unique_ptr<Protocol> server_protocol;
+	std::unique_ptr<Protocol> client_protocol;
+
+	std::vector<std::shared_ptr<void>> owned_signals;
+
+	void SetUp() override
+	{
+		spdlog::set_level(spdlog::level::err);
+		switch (GetParam())
+		{
+			case Transport::Tcp:
+				server_wire = std::make_shared<SocketWire::Server>(lifetime, &server_scheduler, 0, "TestServer");
+				client_wire = std::make_shared<SocketWire::Client>(lifetime, &client_scheduler, server_wire->port, "TestClient");
+				break;
+			case Transport::UnixDomainSocket:
+#ifdef RD_UNIX_DOMAIN_SOCKET
+				server_wire = std::make_shared<SocketWire::Server>(lifetime, &server_scheduler, std::string(), "TestServer");
+				client_wire =
+					std::make_shared<SocketWire::Client>(lifetime, &client_scheduler, server_wire->socket_path, "TestClient");
+				break;
+#else
+				GTEST_SKIP() << "Unix domain sockets are not supported on this platform";
+#endif
+		}
+		server_protocol = std::make_unique<Protocol>(Identities::SERVER, &server_scheduler, server_wire, lifetime);
+		client_protocol = std::make_unique<Protocol>(Identities::CLIENT, &client_scheduler, client_wire, lifetime);
+	}
+
+	void TearDown() override
+	{
+		definition.terminate();
+	}
+
+	template <typename T>
+	struct SignalPair
+	{
+		RdSignal<T> server;
+		RdSignal<T> client;
+	};
+
+	/**
+	 * \brief Binds a signal with the same static id on both sides. The pair is owned by the fixture so that it outlives
+	 * the lifetime terminated in TearDown.
+	 */
+	template <typename T>
+	SignalPair<T>& bind_signals(int64_t id, std::string const& name)
+	{
+		auto pair = std::make_shared<SignalPair<T>>();
+		owned_signals.push_back(pair);
+		statics(pair->server, id);
+		statics(pair->client, id);
+		pair->server.async = true;
+		pair->client.async = true;
+		server_scheduler.queue([this, pair, name] { pair->server.bind(lifetime, server_protocol.get(), name); });
+		client_scheduler.queue([this, pair, name] { pair->client.bind(lifetime, client_protocol.get(), name); });
+		return *pair;
+	}
+
+	void wait_connected()
+	{
+		ASSERT_TRUE(wait_until([this] { return server_wire->connected.get() && client_wire->connected.get(); }));
+		// let both sides exchange the encoding announcement before anything else goes out
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+};
+
+std::string to_string(Transport transport)
+{
+	return transport == Transport::Tcp ? "Tcp" : "UnixDomainSocket";
+}
+
+void PrintTo(Transport transport, std::ostream* os)
+{
+	*os << to_string(transport);
+}
+
+std::string transport_name(::testing::TestParamInfo<Transport> const& info)
+{
+	return to_string(info.param);
+}
+}	 // namespace
+
+TEST_P(SocketWireTest, SignalsTravelBothWays)
+{
+	auto& signals = bind_signals<int32_t>(1, "top");
+
+	// a signal also fires its own handlers locally, so each side waits for the value only the other side sends
+	std::atomic<bool> server_got_client{false}, client_got_server{false};
+	server_scheduler.queue([&] {
+		signals.server.advise(lifetime, [&](int32_t const& v) {
+			if (v == 42)
+				server_got_client = true;
+		});
+	});
+	client_scheduler.queue([&] {
+		signals.client.advise(lifetime, [&](int32_t const& v) {
+			if (v == -7)
+				client_got_server = true;
+		});
+	});
+	wait_connected();
+
+	signals.client.fire(42);
+	signals.server.fire(-7);
+
+	EXPECT_TRUE(wait_until([&] { return server_got_client.load(); }));
+	EXPECT_TRUE(wait_until([&] { return client_got_server.load(); }));
+}
+
+TEST_P(SocketWireTest, ConcurrentProducersKeepPerThreadOrder)
+{
+	constexpr int producers = 4;
+	constexpr int per_producer = 5000;
+
+	auto& signals = bind_signals<int64_t>(1, "top");
+
+	std::vector<int64_t> last(producers, -1);
+	std::atomic<int64_t> received{0};
+	std::atomic<bool> ordered{true};
+	server_scheduler.queue([&] {
+		signals.server.advise(lifetime, [&](int64_t const& v) {
+			auto const producer = static_cast<int>(v >> 32);
+			auto const index = static_cast<int>(v & 0xffffffff);
+			if (index != last[producer] + 1)
+				ordered = false;
+			last[producer] = index;
+			++received;
+		});
+	});
+	wait_connected();
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&, p] {
+			for (int i = 0; i < per_producer; ++i)
+				signals.client.fire((int64_t(p) << 32) | i);
+		});
+	}
+	for (auto& t : threads)
+		t.join();
+
+	EXPECT_TRUE(wait_until([&] { return received == producers * per_producer; })) << "received " << received;
+	EXPECT_TRUE(ordered);
+}
+
+TEST_P(SocketWireTest, LargeMessagesArriveIntact)
+{
+	auto& signals = bind_signals<std::wstring>(2, "big");
+
+	std::atomic<int> intact{0};
+	server_scheduler.queue([&] {
+		signals.server.advise(lifetime, [&](std::wstring const& v) {
+			if (v.size() == 100000u + intact && v.back() == L'z')
+				++intact;
+		});
+	});
+	wait_connected();
+
+	for (int i = 0; i < 3; ++i)
+	{
+		std::wstring value(100000 + i, L'a');
+		value.back() = L'z';
+		signals.client.fire(value);
+	}
+
+	EXPECT_TRUE(wait_until([&] { return intact == 3; })) << "intact " << intact;
+}
+
+TEST_P(SocketWireTest, MessagesSurviveConnectionDrops)
+{
+	constexpr int total = 20000;
+
+	auto& signals = bind_signals<int64_t>(1, "top");
+
+	std::atomic<int64_t> received{0}, last{-1};
+	std::atomic<bool> ordered{true};
+	server_scheduler.queue([&] {
+		signals.server.advise(lifetime, [&](int64_t const& v) {
+			if (v != last + 1)
+				ordered = false;
+			last = v;
+			++received;
+		});
+	});
+	wait_connected();
+
+	std::thread dropper([&] {
+		for (int i = 0; i < 3; ++i)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(15));
+			server_wire->try_shutdown_connection();
+		}
+	});
+	for (int i = 0; i < total; ++i)
+	{
+		signals.client.fire(i);
+		if (i % 1000 == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	dropper.join();
+
+	EXPECT_TRUE(wait_until([&] { return received == total; })) << "received " << received;
+	EXPECT_TRUE(ordered);
+}
+
+INSTANTIATE_TEST_SUITE_P(Transports, SocketWireTest, ::testing::Values(Transport::Tcp, Transport::UnixDomainSocket), transport_name);
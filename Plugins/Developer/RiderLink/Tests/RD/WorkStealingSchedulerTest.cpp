@@ -0,0 +1,111 @@
+#include "scheduler/WorkStealingScheduler.h"
+#include "lifetime/LifetimeDefinition.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+
+namespace
+{
+bool flushes_within(WorkStealingScheduler& scheduler, std::chrono::milliseconds timeout)
+{
+	auto done = std::make_shared<std::atomic<bool>>(false);
+	std::thread flusher([&scheduler, done] {
+		scheduler.flush();
+		*done = true;
+	});
+	auto const deadline = std::chrono::steady_clock::now() + timeout;
+	while (!*done && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (!*done)
+	{
+		// a leaked task keeps flush waiting forever
+		flusher.detach();
+		return false;
+	}
+	flusher.join();
+	return true;
+}
+}	 // namespace
+
+TEST(WorkStealingSchedulerTest, OrderedActionsOfOneKeyRunInOrder)
+{
+	constexpr size_t keys = 8;
+	constexpr int per_key = 2000;
+
+	LifetimeDefinition definition{false};
+	WorkStealingScheduler scheduler(definition.lifetime, "OrderedTest", 4);
+
+	std::vector<int> last(keys, -1);
+	std::atomic<int> out_of_order{0};
+	std::vector<std::thread> producers;
+	for (size_t key = 0; key < keys; ++key)
+	{
+		producers.emplace_back([&, key] {
+			for (int i = 0; i < per_key; ++i)
+			{
+				scheduler.queue_ordered(key, [&, key, i] {
+					if (last[key] != i - 1)
+						++out_of_order;
+					last[key] = i;
+				});
+			}
+		});
+	}
+	for (auto& producer : producers)
+		producer.join();
+
+	ASSERT_TRUE(flushes_within(scheduler, std::chrono::seconds(30)));
+	EXPECT_EQ(0, out_of_order.load());
+	for (size_t key = 0; key < keys; ++key)
+		EXPECT_EQ(per_key - 1, last[key]);
+	definition.terminate();
+}
+
+TEST(WorkStealingSchedulerTest, ActionsQueuedWhileStoppingDontLeak)
+{
+	for (int round = 0; round < 100; ++round)
+	{
+		LifetimeDefinition definition{false};
+		// the name registers a logger, it has to be unique
+		auto scheduler = std::make_unique<WorkStealingScheduler>(definition.lifetime, "StoppingTest" + std::to_string(round), 2);
+
+		// producers keep queuing until the scheduler has stopped, so some of them race with stop()
+		std::atomic<bool> stopped{false};
+		std::vector<std::thread> producers;
+		for (int p = 0; p < 3; ++p)
+		{
+			producers.emplace_back([&, p] {
+				for (int i = 0; !stopped; ++i)
+				{
+					if (i % 2 == 0)
+						scheduler->queue([] {});
+					else
+						scheduler->queue_ordered(static_cast<size_t>(p), [] {});
+				}
+			});
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		definition.terminate();
+		stopped = true;
+		for (auto& producer : producers)
+			producer.join();
+
+		// everything accepted has run, nothing is left counted in a deque nobody takes from
+		if (!flushes_within(*scheduler, std::chrono::seconds(10)))
+		{
+			// the flushing thread still waits on it
+			scheduler.release();
+			FAIL() << "a task is left unfinished, round " << round;
+		}
+	}
+}
@@ -3,6 +3,7 @@
 
 #include "Ammo.h"
 
+#include "ItemStateProfile.h"
 #include "ShooterCharacter.h"
 #include "Components/BoxComponent.h"
 #include "Components/SphereComponent.h"
@@ -30,51 +31,16 @@ void AAmmo::BeginPlay()
 }
 
 
-void AAmmo::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-}
-
 void AAmmo::SetItemProperties(EItemState State)
 {
 	Super::SetItemProperties(State);
 
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
+	// picked up ammo gets destroyed, its mesh is left as it is
+	if (State == EItemState::EIS_PickedUp) return;
 
-	case EItemState::EIS_Equipped:
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-
-	case EItemState::EIS_Falling:
-		AmmoMesh->SetSimulatePhysics(true);
-		AmmoMesh->SetEnableGravity(true);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
-		break;
-
-	case EItemState::EIS_EquipInterping:
-		AmmoMesh->SetSimulatePhysics(false);
-		AmmoMesh->SetEnableGravity(false);
-		AmmoMesh->SetVisibility(true);
-		AmmoMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AmmoMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	default:
-		break;
+	if (const FItemStateProfile* Profile = FItemStateProfiles::Get(State))
+	{
+		FItemStateProfiles::Apply(AmmoMesh, Profile->Mesh);
 	}
 }
 
@@ -17,7 +17,6 @@ class THIRDPERSONESHOOTER_API AAmmo : public AItem
 
 public:
 	AAmmo();
-	virtual void Tick(float DeltaTime) override;
 
 protected:
 	virtual void BeginPlay() override;
@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrosshairTraceSubsystem.h"
+
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crosshair trace batch"), STAT_CrosshairTraceBatch, STATGROUP_CrosshairTrace);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair trace requests"), STAT_CrosshairTraceRequests, STATGROUP_CrosshairTrace);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Async traces issued"), STAT_CrosshairAsyncTraces, STATGROUP_CrosshairTrace);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sync traces issued"), STAT_CrosshairSyncTraces, STATGROUP_CrosshairTrace);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Traces saved"), STAT_CrosshairTracesSaved, STATGROUP_CrosshairTrace);
+
+void UCrosshairTraceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	AsyncTraceDelegate.BindUObject(this, &UCrosshairTraceSubsystem::OnAsyncTraceCompleted);
+}
+
+void UCrosshairTraceSubsystem::Deinitialize()
+{
+	AsyncTraceDelegate.Unbind();
+	Traces.Empty();
+	RequestedControllers.Empty();
+	PendingTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCrosshairTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrosshairTraceSubsystem, STATGROUP_CrosshairTrace);
+}
+
+void UCrosshairTraceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_CrosshairTraceBatch);
+
+	// results of the previous batch have been delivered at the start of this frame
+	PendingTraces.Reset();
+	BatchFrame = GFrameCounter;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || RequestedControllers.Num() == 0)
+	{
+		UpdateTracesSaved(0);
+		return;
+	}
+
+	// deproject once per controller and send all the traces as one batch
+	for (const TWeakObjectPtr<APlayerController>& WeakController : RequestedControllers)
+	{
+		APlayerController* PlayerController = WeakController.Get();
+		if (PlayerController == nullptr) continue;
+
+		FPendingTrace Pending{WeakController, FVector(0.f), FVector(0.f)};
+		if (!DeprojectCrosshair(PlayerController, Pending.Start, Pending.Direction)) continue;
+
+		const FVector End{Pending.Start + Pending.Direction * MAX_TRACE_DISTANCE};
+		const uint32 UserData = static_cast<uint32>(PendingTraces.Add(Pending));
+		World->AsyncLineTraceByChannel(
+			EAsyncTraceType::Single,
+			Pending.Start,
+			End,
+			ECollisionChannel::ECC_Visibility,
+			FCollisionQueryParams::DefaultQueryParam,
+			FCollisionResponseParams::DefaultResponseParam,
+			&AsyncTraceDelegate,
+			UserData);
+		INC_DWORD_STAT(STAT_CrosshairAsyncTraces);
+	}
+	UpdateTracesSaved(PendingTraces.Num());
+
+	// callers keep a controller in the batch by asking for its trace again next frame
+	RequestedControllers.Reset();
+
+	// forget controllers that stopped asking
+	for (auto It = Traces.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid() || It->Value.Frame + 1 < GFrameCounter)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool UCrosshairTraceSubsystem::GetCrosshairTrace(APlayerController* PlayerController, FCrosshairTrace& OutTrace)
+{
+	if (PlayerController == nullptr) return false;
+	INC_DWORD_STAT(STAT_CrosshairTraceRequests);
+	++RequestsSinceBatch;
+
+	RequestedControllers.Add(PlayerController);
+
+	// a trace from the end of last frame or from earlier this frame is good enough
+	const FCrosshairTrace* CachedTrace = Traces.Find(PlayerController);
+	if (CachedTrace && CachedTrace->Frame + 1 >= GFrameCounter)
+	{
+		OutTrace = *CachedTrace;
+		return true;
+	}
+
+	// nothing cached for this controller yet, trace now
+	FPendingTrace Pending{PlayerController, FVector(0.f), FVector(0.f)};
+	if (!DeprojectCrosshair(PlayerController, Pending.Start, Pending.Direction))
+	{
+		return false;
+	}
+
+	FHitResult HitResult;
+	GetWorld()->LineTraceSingleByChannel(
+		HitResult,
+		Pending.Start,
+		Pending.Start + Pending.Direction * MAX_TRACE_DISTANCE,
+		ECollisionChannel::ECC_Visibility);
+	INC_DWORD_STAT(STAT_CrosshairSyncTraces);
+	++SyncTracesSinceBatch;
+
+	StoreTrace(PlayerController, Pending, HitResult, GFrameCounter);
+	OutTrace = Traces.FindChecked(PlayerController);
+	return true;
+}
+
+void UCrosshairTraceSubsystem::UpdateTracesSaved(int32 AsyncTraces)
+{
+	// every request since the last batch is served by a sync trace, by the batch issued now or by a trace shared
+	// with another request
+	const int64 Issued{static_cast<int64>(SyncTracesSinceBatch) + AsyncTraces};
+	SET_DWORD_STAT(STAT_CrosshairTracesSaved, FMath::Max<int64>(static_cast<int64>(RequestsSinceBatch) - Issued, 0));
+	RequestsSinceBatch = 0;
+	SyncTracesSinceBatch = 0;
+}
+
+bool UCrosshairTraceSubsystem::DeprojectCrosshair(
+	APlayerController* PlayerController,
+	FVector& OutStart,
+	FVector& OutDirection)
+{
+	// Get Viewport Size
+	int32 ViewportSizeX{0};
+	int32 ViewportSizeY{0};
+	PlayerController->GetViewportSize(ViewportSizeX, ViewportSizeY);
+
+	// Get screen space location of crosshairs
+	const float CrosshairX{ViewportSizeX / 2.f};
+	const float CrosshairY{ViewportSizeY / 2.f + CROSSHAIR_Y_OFFSET};
+
+	// Get world position and direction of crosshairs
+	return PlayerController->DeprojectScreenPositionToWorld(CrosshairX, CrosshairY, OutStart, OutDirection);
+}
+
+void UCrosshairTraceSubsystem::StoreTrace(
+	APlayerController* PlayerController,
+	const FPendingTrace& Pending,
+	const FHitResult& HitResult,
+	uint64 Frame)
+{
+	FCrosshairTrace& Trace = Traces.FindOrAdd(PlayerController);
+	Trace.Start = Pending.Start;
+	Trace.Direction = Pending.Direction;
+	Trace.HitResult = HitResult;
+	Trace.bBlockingHit = HitResult.bBlockingHit;
+	Trace.HitLocation = HitResult.bBlockingHit
+		                    ? FVector(HitResult.Location)
+		                    : Pending.Start + Pending.Direction * MAX_TRACE_DISTANCE;
+	Trace.Frame = Frame;
+}
+
+void UCrosshairTraceSubsystem::OnAsyncTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	if (!PendingTraces.IsValidIndex(Datum.UserData)) return;
+
+	const FPendingTrace& Pending = PendingTraces[Datum.UserData];
+	APlayerController* PlayerController = Pending.PlayerController.Get();
+	if (PlayerController == nullptr) return;
+
+	const FHitResult HitResult = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+	StoreTrace(PlayerController, Pending, HitResult, BatchFrame);
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CrosshairTraceSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("CrosshairTrace"), STATGROUP_CrosshairTrace, STATCAT_Advanced);
+
+// result of one crosshair deprojection and line trace for a player controller
+struct FCrosshairTrace
+{
+	// world position and direction of the crosshairs
+	FVector Start{0.f};
+	FVector Direction{0.f};
+
+	// end of the trace, or the hit location when the trace blocked
+	FVector HitLocation{0.f};
+
+	FHitResult HitResult;
+
+	// true when the trace hit something blocking on the visibility channel
+	bool bBlockingHit{false};
+
+	// GFrameCounter value of the frame this trace describes
+	uint64 Frame{0};
+};
+
+/**
+ * Computes the crosshair trace once per player controller per frame and shares the result between
+ * every caller (item highlighting, weapon fire ...).
+ * Controllers that asked for a trace last frame are traced again in one AsyncLineTraceByChannel batch at the
+ * end of the frame, so next frame's callers read a finished result instead of tracing themselves.
+ */
+UCLASS()
+class THIRDPERSONESHOOTER_API UCrosshairTraceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	inline static const float MAX_TRACE_DISTANCE{50000.f};
+
+	// screen space offset of the crosshairs from the viewport centre
+	inline static const float CROSSHAIR_Y_OFFSET{-50.f};
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Gets the crosshair trace for this controller.
+	 * Uses the result of the last async batch when it is recent enough, otherwise traces synchronously and
+	 * caches the result so other callers in the same frame get it for free.
+	 * @return false if the crosshairs could not be deprojected
+	 */
+	bool GetCrosshairTrace(APlayerController* PlayerController, FCrosshairTrace& OutTrace);
+
+private:
+	struct FPendingTrace
+	{
+		TWeakObjectPtr<APlayerController> PlayerController;
+		FVector Start;
+		FVector Direction;
+	};
+
+	// deprojects the crosshair location of the controller's viewport
+	static bool DeprojectCrosshair(APlayerController* PlayerController, FVector& OutStart, FVector& OutDirection);
+
+	void StoreTrace(APlayerController* PlayerController, const FPendingTrace& Pending, const FHitResult& HitResult,
+	                uint64 Frame);
+
+	// sets STAT_CrosshairTracesSaved to the requests since the last batch minus the traces issued for them
+	void UpdateTracesSaved(int32 AsyncTraces);
+
+	// called by the async trace system when a batched trace finishes
+	void OnAsyncTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	// latest trace for every controller that asked for one
+	TMap<TWeakObjectPtr<APlayerController>, FCrosshairTrace> Traces;
+
+	// controllers that asked for a trace this frame. they are traced in the next batch
+	TSet<TWeakObjectPtr<APlayerController>> RequestedControllers;
+
+	// traces of the batch in flight, indexed by FTraceDatum::UserData
+	TArray<FPendingTrace> PendingTraces;
+
+	// GFrameCounter value when the batch in flight was issued
+	uint64 BatchFrame{0};
+
+	// requests and sync traces since the last batch, the traces saved are the requests that didn't need one
+	uint32 RequestsSinceBatch{0};
+	uint32 SyncTracesSinceBatch{0};
+
+	FTraceDelegate AsyncTraceDelegate;
+};
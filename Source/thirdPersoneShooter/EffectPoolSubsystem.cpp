@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EffectPoolSubsystem.h"
+
+#include "GameFramework/WorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool hits per second"), STAT_EffectPoolHits, STATGROUP_EffectPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool misses per second"), STAT_EffectPoolMisses, STATGROUP_EffectPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Component allocations per second"), STAT_EffectPoolAllocations, STATGROUP_EffectPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled components"), STAT_EffectPoolComponents, STATGROUP_EffectPool);
+
+void UEffectPoolSubsystem::Deinitialize()
+{
+	for (UParticleSystemComponent* Component : PooledComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->OnSystemFinished.RemoveAll(this);
+			Component->DestroyComponent();
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_EffectPoolComponents, PooledComponents.Num());
+	PooledComponents.Empty();
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UEffectPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEffectPoolSubsystem, STATGROUP_EffectPool);
+}
+
+void UEffectPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// wall clock, DeltaTime is scaled by time dilation
+	const double Now = FPlatformTime::Seconds();
+	if (RateWindowStart == 0.0)
+	{
+		RateWindowStart = Now;
+	}
+	else if (Now - RateWindowStart >= 1.0)
+	{
+		UpdateRateStats(Now);
+	}
+}
+
+void UEffectPoolSubsystem::UpdateRateStats(double Now)
+{
+	const double Elapsed = Now - RateWindowStart;
+	SET_DWORD_STAT(STAT_EffectPoolHits, FMath::RoundToInt(HitsSinceUpdate / Elapsed));
+	SET_DWORD_STAT(STAT_EffectPoolMisses, FMath::RoundToInt(MissesSinceUpdate / Elapsed));
+	SET_DWORD_STAT(STAT_EffectPoolAllocations, FMath::RoundToInt(AllocationsSinceUpdate / Elapsed));
+	HitsSinceUpdate = 0;
+	MissesSinceUpdate = 0;
+	AllocationsSinceUpdate = 0;
+	RateWindowStart = Now;
+}
+
+UParticleSystemComponent* UEffectPoolSubsystem::SpawnEmitterAtLocation(
+	UParticleSystem* Template,
+	const FTransform& Transform)
+{
+	if (Template == nullptr) return nullptr;
+
+	FEffectPool& Pool = Pools.FindOrAdd(Template);
+
+	UParticleSystemComponent* Component{nullptr};
+	while (Pool.FreeComponents.Num() > 0 && Component == nullptr)
+	{
+		Component = Pool.FreeComponents.Pop(false);
+		if (!IsValid(Component))
+		{
+			// destroyed from outside, e.g. by a level streaming out
+			--Pool.NumComponents;
+			Component = nullptr;
+		}
+	}
+
+	if (Component)
+	{
+		++HitsSinceUpdate;
+	}
+	else if (Pool.NumComponents < MaxPoolSizePerTemplate)
+	{
+		++MissesSinceUpdate;
+		Component = CreatePooledComponent(Template);
+		++Pool.NumComponents;
+	}
+	else
+	{
+		// pool is full and every component is playing, spawn one that cleans up after itself
+		++MissesSinceUpdate;
+		++AllocationsSinceUpdate;
+		return UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Template, Transform);
+	}
+
+	Component->SetWorldTransform(Transform);
+	Component->ActivateSystem(true);
+	return Component;
+}
+
+UParticleSystemComponent* UEffectPoolSubsystem::CreatePooledComponent(UParticleSystem* Template)
+{
+	++AllocationsSinceUpdate;
+	INC_DWORD_STAT(STAT_EffectPoolComponents);
+
+	// same outer as UGameplayStatics::SpawnEmitterAtLocation, but kept alive after it finishes
+	UWorld* World = GetWorld();
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(
+		World->GetWorldSettings(), NAME_None, RF_Transient);
+	Component->bAutoDestroy = false;
+	Component->bAutoActivate = false;
+	Component->SetUsingAbsoluteLocation(true);
+	Component->SetUsingAbsoluteRotation(true);
+	Component->SetUsingAbsoluteScale(true);
+	Component->SetTemplate(Template);
+	Component->OnSystemFinished.AddDynamic(this, &UEffectPoolSubsystem::OnEmitterFinished);
+	Component->RegisterComponentWithWorld(World);
+
+	PooledComponents.Add(Component);
+	return Component;
+}
+
+void UEffectPoolSubsystem::OnEmitterFinished(UParticleSystemComponent* Component)
+{
+	if (Component == nullptr) return;
+
+	FEffectPool* Pool = Pools.Find(Component->Template);
+	if (Pool)
+	{
+		Pool->FreeComponents.AddUnique(Component);
+	}
+}
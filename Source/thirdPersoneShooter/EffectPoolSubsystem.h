@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EffectPoolSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("EffectPool"), STATGROUP_EffectPool, STATCAT_Advanced);
+
+/**
+ * Per world pool of particle system components, keyed by particle template.
+ * Short lived effects (muzzle flashes, impacts, beams) reuse a component that finished playing instead of
+ * spawning a new one that the GC has to collect afterwards.
+ * The number of components kept per template is MaxPoolSizePerTemplate, set in
+ * [/Script/thirdPersoneShooter.EffectPoolSubsystem] of DefaultGame.ini.
+ * Hits, misses and allocations are reported in STATGROUP_EffectPool as rates per second.
+ */
+UCLASS(Config=Game)
+class THIRDPERSONESHOOTER_API UEffectPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Plays Template at Transform with a pooled component.
+	 * When every pooled component of the template is busy and the pool is full, falls back to spawning a
+	 * regular auto destroying emitter.
+	 */
+	class UParticleSystemComponent* SpawnEmitterAtLocation(class UParticleSystem* Template, const FTransform& Transform);
+
+private:
+	struct FEffectPool
+	{
+		// components which finished playing and can be reused
+		TArray<class UParticleSystemComponent*> FreeComponents;
+
+		// every component owned by this pool, free or playing
+		int32 NumComponents{0};
+	};
+
+	class UParticleSystemComponent* CreatePooledComponent(class UParticleSystem* Template);
+
+	// sets the per second stats from the counts since the last update and resets the counts
+	void UpdateRateStats(double Now);
+
+	// returns the component to its pool once it stops playing
+	UFUNCTION()
+	void OnEmitterFinished(class UParticleSystemComponent* Component);
+
+	// max components kept alive for each particle template
+	UPROPERTY(Config)
+	int32 MaxPoolSizePerTemplate{16};
+
+	TMap<class UParticleSystem*, FEffectPool> Pools;
+
+	// keeps every pooled component alive
+	UPROPERTY()
+	TArray<class UParticleSystemComponent*> PooledComponents;
+
+	// counts since RateWindowStart, turned into per second stats by UpdateRateStats
+	uint32 HitsSinceUpdate{0};
+	uint32 MissesSinceUpdate{0};
+	uint32 AllocationsSinceUpdate{0};
+	double RateWindowStart{0.0};
+};
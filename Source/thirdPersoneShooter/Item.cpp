@@ -3,6 +3,9 @@
 
 #include "Item.h"
 
+#include "ItemDataSubsystem.h"
+#include "ItemPulseSubsystem.h"
+#include "ItemStateProfile.h"
 #include "ShooterCharacter.h"
 #include "Camera/CameraComponent.h"
 #include "Components/BoxComponent.h"
@@ -12,6 +15,8 @@
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 
+DECLARE_CYCLE_STAT(TEXT("Item state transition"), STAT_ItemStateTransition, STATGROUP_ItemState);
+
 // Sets default values
 AItem::AItem():
 	ItemName(FString("Item Name Here")),
@@ -41,8 +46,9 @@ AItem::AItem():
 	SlotIndex(0),
 	bCharacterInventoryFull(false)
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Items only tick while they are interping or pulsing. UpdateTickEnabled turns ticking on and off
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
 	SetRootComponent(ItemMesh);
 
@@ -76,14 +82,21 @@ void AItem::BeginPlay()
 	AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereBeginOverlap);
 	AreaSphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
 
-	// Set item properties based on it's current state
-	SetItemProperties(ItemState);
+	// Set item properties and tick interval based on it's current state
+	SetItemState(ItemState);
 
 	// set custom depth to disable
 	InitializeCustomDepth();
 
 	// start item flashing
-	StartPulseTimer();
+	StartPulse();
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopPulse();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -94,7 +107,7 @@ void AItem::Tick(float DeltaTime)
 	// handle the item interping when in the Interping state
 	ItemInterp(DeltaTime);
 
-	// Get curve values from Pulse curve and set dynamic material parameters
+	// Get curve values from the interp pulse curve and set dynamic material parameters
 	UpdatePulse();
 }
 
@@ -102,6 +115,35 @@ void AItem::SetItemState(EItemState State)
 {
 	ItemState = State;
 	SetItemProperties(ItemState);
+
+	// only pickups lying in the world pulse
+	if (ItemState != EItemState::EIS_Pickup)
+	{
+		StopPulse();
+	}
+
+	const float* TickInterval = StateTickIntervals.Find(ItemState);
+	SetActorTickInterval(TickInterval ? *TickInterval : 0.f);
+	UpdateTickEnabled();
+}
+
+bool AItem::ShouldTick() const
+{
+	// the pickup pulse is driven by UItemPulseSubsystem
+	return bInterping;
+}
+
+void AItem::UpdateTickEnabled()
+{
+	const bool bShouldTick = ShouldTick();
+	if (bShouldTick == IsActorTickEnabled()) return;
+
+	if (!bShouldTick)
+	{
+		// leave the material parameters matching the current state before going idle
+		UpdatePulse();
+	}
+	SetActorTickEnabled(bShouldTick);
 }
 
 void AItem::OnSphereBeginOverlap(
@@ -186,88 +228,20 @@ void AItem::SetActiveStarts()
 
 void AItem::SetItemProperties(EItemState State)
 {
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		break;
-
-	case EItemState::EIS_PickedUp:
-		PickupWidget->SetVisibility(false);
-
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-
-	case EItemState::EIS_Equipped:
-		PickupWidget->SetVisibility(false);
-
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-
-	case EItemState::EIS_Falling:
-		ItemMesh->SetSimulatePhysics(true);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Block);
+	SCOPE_CYCLE_COUNTER(STAT_ItemStateTransition);
 
+	// look up the precomputed setup for this state and only touch what changes
+	const FItemStateProfile* Profile = FItemStateProfiles::Get(State);
+	if (Profile == nullptr) return;
 
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_EquipInterping:
+	if (Profile->bHidePickupWidget)
+	{
 		PickupWidget->SetVisibility(false);
-
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	default:
-		break;
 	}
+
+	FItemStateProfiles::Apply(ItemMesh, Profile->Mesh);
+	FItemStateProfiles::Apply(AreaSphere, Profile->AreaSphere);
+	FItemStateProfiles::Apply(CollisionBox, Profile->CollisionBox);
 }
 
 void AItem::StartItemCurve(AShooterCharacter* InteractingCharacter, bool ForcePlaySound)
@@ -288,7 +262,6 @@ void AItem::StartItemCurve(AShooterCharacter* InteractingCharacter, bool ForcePl
 	bInterping = true;
 	SetItemState(EItemState::EIS_EquipInterping);
 	GetWorldTimerManager().SetTimer(ItemInterpTimer, this, &AItem::FinishInterping, ZCurveTime);
-	GetWorldTimerManager().ClearTimer(PulseTimer);
 
 	// Get initial Yaws of the camera and the item
 	const double CameraRotationYaw{Character->GetFollowCamera()->GetComponentRotation().Yaw};
@@ -313,6 +286,12 @@ void AItem::FinishInterping()
 	bCanChangeCustomDepth = true;
 	DisableGlowMaterial();
 	DisableCustomDepth();
+
+	// nothing left to interp. picked up ammo has already been destroyed
+	if (!IsActorBeingDestroyed())
+	{
+		UpdateTickEnabled();
+	}
 }
 
 void AItem::ItemInterp(float DeltaTime)
@@ -450,41 +429,11 @@ void AItem::OnConstruction(const FTransform& Transform)
 {
 	//Super::OnConstruction(Transform);
 
-	/* load data in the item rarity datatable*/
-	// 1 path to the item rarity datatable
-	auto RarityTablePath = TEXT("DataTable'/Game/_Game/DataTables/ItemRarityDataTable.ItemRarityDataTable'");
-
-	UDataTable* RarityTableObject = Cast<UDataTable>(
-		StaticLoadObject(UDataTable::StaticClass(), nullptr, RarityTablePath));
-	
-	if (RarityTableObject)
+	/* get the row of the item rarity datatable, cached by UItemDataSubsystem*/
+	UItemDataSubsystem* ItemDataSubsystem = UItemDataSubsystem::Get();
+	if (ItemDataSubsystem)
 	{
-		FItemRarityTable* RarityRow = nullptr;
-		switch (ItemRarity)
-		{
-		case EItemRarity::EIR_Damaged:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Damaged"), TEXT(""));
-			break;
-
-		case EItemRarity::EIR_Common:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Common"), TEXT(""));
-			break;
-
-		case EItemRarity::EIR_Uncommon:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Uncommon"), TEXT(""));
-			break;
-
-		case EItemRarity::EIR_Rare:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Rare"), TEXT(""));
-			break;
-
-		case EItemRarity::EIR_Legendary:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Legendary"), TEXT(""));
-			break;
-
-		default:
-			break;
-		}
+		const FItemRarityTable* RarityRow = ItemDataSubsystem->GetRarityRow(ItemRarity);
 
 		// check if rarity row is valid
 		if(RarityRow)
@@ -528,40 +477,36 @@ void AItem::DisableGlowMaterial()
 }
 
 
-void AItem::StartPulseTimer()
+void AItem::StartPulse()
 {
-	if (ItemState == EItemState::EIS_Pickup)
+	if (ItemState != EItemState::EIS_Pickup) return;
+
+	if (UItemPulseSubsystem* ItemPulseSubsystem = GetWorld()->GetSubsystem<UItemPulseSubsystem>())
 	{
-		GetWorldTimerManager().SetTimer(PulseTimer, this, &AItem::ResetPulseTimer, PulseCurveTime);
+		ItemPulseSubsystem->RegisterItem(this);
 	}
 }
 
-void AItem::ResetPulseTimer()
+void AItem::StopPulse()
 {
-	StartPulseTimer();
+	UWorld* World = GetWorld();
+	if (World == nullptr) return;
+
+	if (UItemPulseSubsystem* ItemPulseSubsystem = World->GetSubsystem<UItemPulseSubsystem>())
+	{
+		ItemPulseSubsystem->UnregisterItem(this);
+	}
 }
 
 void AItem::UpdatePulse()
 {
+	// pickups are pulsed by UItemPulseSubsystem, only the interp pulse is done per item
 	FVector CurveValue{};
-	switch (ItemState)
+	if (ItemState == EItemState::EIS_EquipInterping && InterpPulseCurve)
 	{
-	case EItemState::EIS_Pickup:
-		if (PulseCurve)
-		{
-			float ELapsedTime = GetWorldTimerManager().GetTimerElapsed(PulseTimer);
-			CurveValue = PulseCurve->GetVectorValue(ELapsedTime);
-		}
-		break;
-
-	case EItemState::EIS_EquipInterping:
-		if (InterpPulseCurve)
-		{
-			float ELapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-			CurveValue = InterpPulseCurve->GetVectorValue(ELapsedTime);
-		}
-		break;
-	};
+		float ELapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
+		CurveValue = InterpPulseCurve->GetVectorValue(ELapsedTime);
+	}
 
 	if (DynamicMaterialInstance)
 	{
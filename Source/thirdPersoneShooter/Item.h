@@ -82,6 +82,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called when overlapping area sphere begins
 	UFUNCTION()
 	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent,
@@ -124,6 +126,12 @@ protected:
 
 	void UpdatePulse();
 
+	// true while the item has per frame work to do (interping)
+	virtual bool ShouldTick() const;
+
+	// turns ticking on or off depending on ShouldTick. call whenever one of its inputs changes
+	void UpdateTickEnabled();
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -236,11 +244,9 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category=ItemProperties, meta=(AllowPrivateAccess="true"))
 	class UCurveVector* InterpPulseCurve;
 
-	// time for the pulse timer
+	// duration of one pulse of PulseCurve
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category=ItemProperties, meta=(AllowPrivateAccess="true"))
 	float PulseCurveTime;
-	
-	FTimerHandle PulseTimer;
 
 	// comes from material instance M_SMG_Mat_Inst
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=ItemProperties, meta=(AllowPrivateAccess="true"))
@@ -251,7 +257,10 @@ private:
 	// comes from material instance M_SMG_Mat_Inst
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=ItemProperties, meta=(AllowPrivateAccess="true"))
 	float FresnelReflectFraction;
-	void ResetPulseTimer();
+
+	// seconds between ticks while the item is in a given state. states not in the map tick every frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=ItemProperties, meta=(AllowPrivateAccess="true"))
+	TMap<EItemState, float> StateTickIntervals;
 
 	// icon for this item in the inventory
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Inventory, meta=(AllowPrivateAccess="true"))
@@ -333,6 +342,12 @@ public:
 	FORCEINLINE int32 GetMaterialIndex() const { return MaterialIndex; }
 	FORCEINLINE void SetMaterialIndex(int32 x) { MaterialIndex = x; }
 	FORCEINLINE FLinearColor GetGlowColor() const { return GlowColor; }
+
+	FORCEINLINE class UCurveVector* GetPulseCurve() const { return PulseCurve; }
+	FORCEINLINE float GetPulseCurveTime() const { return PulseCurveTime; }
+	FORCEINLINE float GetGlowAmount() const { return GlowAmount; }
+	FORCEINLINE float GetFresnelExponent() const { return FresnelExponent; }
+	FORCEINLINE float GetFresnelReflectFraction() const { return FresnelReflectFraction; }
 	
 
 	void SetItemState(EItemState State);
@@ -344,5 +359,8 @@ public:
 	virtual void EnableCustomDepth();
 	virtual void DisableCustomDepth();
 	void DisableGlowMaterial();
-	void StartPulseTimer();
+
+	// hands the pickup glow pulse over to UItemPulseSubsystem while in the Pickup state
+	void StartPulse();
+	void StopPulse();
 };
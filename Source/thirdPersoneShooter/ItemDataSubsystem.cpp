@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemDataSubsystem.h"
+
+namespace
+{
+	const TCHAR* RarityTablePath{TEXT("DataTable'/Game/_Game/DataTables/ItemRarityDataTable.ItemRarityDataTable'")};
+	const TCHAR* WeaponTablePath{TEXT("DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'")};
+
+	// row names in EItemRarity order
+	const TCHAR* RarityRowNames[]{
+		TEXT("Damaged"),
+		TEXT("Common"),
+		TEXT("Uncommon"),
+		TEXT("Rare"),
+		TEXT("Legendary"),
+	};
+	static_assert(UE_ARRAY_COUNT(RarityRowNames) == static_cast<int32>(EItemRarity::EIR_Max),
+		"RarityRowNames must have one row per EItemRarity");
+
+	// row names in EWeaponType order
+	const TCHAR* WeaponRowNames[]{
+		TEXT("SubMachineGun"),
+		TEXT("AssaultRifle"),
+		TEXT("Pistol"),
+	};
+	static_assert(UE_ARRAY_COUNT(WeaponRowNames) == static_cast<int32>(EWeaponType::EWT_MAX),
+		"WeaponRowNames must have one row per EWeaponType");
+}
+
+UItemDataSubsystem* UItemDataSubsystem::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UItemDataSubsystem>() : nullptr;
+}
+
+void UItemDataSubsystem::Deinitialize()
+{
+	UnbindTableChanged(ItemRarityDataTable);
+	UnbindTableChanged(WeaponDataTable);
+	ItemRarityDataTable = nullptr;
+	WeaponDataTable = nullptr;
+	RarityRows.Empty();
+	WeaponRows.Empty();
+	bTablesLoaded = false;
+
+	Super::Deinitialize();
+}
+
+const FItemRarityTable* UItemDataSubsystem::GetRarityRow(EItemRarity Rarity)
+{
+	LoadTablesIfNeeded();
+
+	const int32 Index = static_cast<int32>(Rarity);
+	return RarityRows.IsValidIndex(Index) ? RarityRows[Index] : nullptr;
+}
+
+const FWeaponDataTable* UItemDataSubsystem::GetWeaponRow(EWeaponType WeaponType)
+{
+	LoadTablesIfNeeded();
+
+	const int32 Index = static_cast<int32>(WeaponType);
+	return WeaponRows.IsValidIndex(Index) ? WeaponRows[Index] : nullptr;
+}
+
+void UItemDataSubsystem::ReloadTables()
+{
+	bTablesLoaded = false;
+	LoadTablesIfNeeded();
+}
+
+void UItemDataSubsystem::LoadTablesIfNeeded()
+{
+	if (bTablesLoaded) return;
+
+	// loading is deferred to the first lookup, content is not mounted yet when engine subsystems initialize
+	if (ItemRarityDataTable == nullptr)
+	{
+		ItemRarityDataTable = LoadTable(RarityTablePath);
+	}
+	if (WeaponDataTable == nullptr)
+	{
+		WeaponDataTable = LoadTable(WeaponTablePath);
+	}
+
+	// a table that failed to load is tried again on the next lookup
+	bTablesLoaded = ItemRarityDataTable && WeaponDataTable;
+
+	ResolveRows();
+}
+
+UDataTable* UItemDataSubsystem::LoadTable(const TCHAR* Path)
+{
+	UDataTable* Table = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, Path));
+	if (Table == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to load item data table %s"), Path);
+		return nullptr;
+	}
+	BindTableChanged(Table);
+	return Table;
+}
+
+void UItemDataSubsystem::ResolveRows()
+{
+	RarityRows.Init(nullptr, static_cast<int32>(EItemRarity::EIR_Max));
+	WeaponRows.Init(nullptr, static_cast<int32>(EWeaponType::EWT_MAX));
+
+	if (ItemRarityDataTable)
+	{
+		for (int32 i = 0; i < RarityRows.Num(); i++)
+		{
+			RarityRows[i] = ItemRarityDataTable->FindRow<FItemRarityTable>(FName(RarityRowNames[i]), TEXT(""));
+		}
+	}
+
+	if (WeaponDataTable)
+	{
+		for (int32 i = 0; i < WeaponRows.Num(); i++)
+		{
+			WeaponRows[i] = WeaponDataTable->FindRow<FWeaponDataTable>(FName(WeaponRowNames[i]), TEXT(""));
+		}
+	}
+}
+
+void UItemDataSubsystem::BindTableChanged(UDataTable* Table)
+{
+#if WITH_EDITOR
+	// row pointers are invalid once a table is edited or reimported
+	if (Table)
+	{
+		Table->OnDataTableChanged().AddUObject(this, &UItemDataSubsystem::ResolveRows);
+	}
+#endif
+}
+
+void UItemDataSubsystem::UnbindTableChanged(UDataTable* Table)
+{
+#if WITH_EDITOR
+	if (Table)
+	{
+		Table->OnDataTableChanged().RemoveAll(this);
+	}
+#endif
+}
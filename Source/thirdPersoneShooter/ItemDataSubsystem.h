@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "ItemDataSubsystem.generated.h"
+
+/**
+ * Loads the weapon and item rarity data tables once and resolves their rows into arrays indexed by
+ * EWeaponType and EItemRarity, so item construction is an array lookup instead of a load and a FindRow.
+ * This is an engine subsystem so OnConstruction in the editor gets the cached rows as well.
+ * The rows are resolved again when a table changes (for example after a reimport).
+ */
+UCLASS()
+class THIRDPERSONESHOOTER_API UItemDataSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// nullptr if the table or the row for this rarity is missing
+	const FItemRarityTable* GetRarityRow(EItemRarity Rarity);
+
+	// nullptr if the table or the row for this weapon type is missing
+	const FWeaponDataTable* GetWeaponRow(EWeaponType WeaponType);
+
+	// loads the tables if needed and resolves the rows again
+	void ReloadTables();
+
+	// the subsystem of the running engine, nullptr before the engine is up
+	static UItemDataSubsystem* Get();
+
+private:
+	void LoadTablesIfNeeded();
+	UDataTable* LoadTable(const TCHAR* Path);
+	void ResolveRows();
+	void BindTableChanged(UDataTable* Table);
+	void UnbindTableChanged(UDataTable* Table);
+
+	UPROPERTY()
+	UDataTable* ItemRarityDataTable;
+
+	UPROPERTY()
+	UDataTable* WeaponDataTable;
+
+	// rows indexed by EItemRarity and EWeaponType
+	TArray<const FItemRarityTable*> RarityRows;
+	TArray<const FWeaponDataTable*> WeaponRows;
+
+	bool bTablesLoaded{false};
+};
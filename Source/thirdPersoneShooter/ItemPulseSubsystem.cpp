@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemPulseSubsystem.h"
+
+#include "Item.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Curves/CurveVector.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item pulse update"), STAT_ItemPulseUpdate, STATGROUP_ItemPulse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pulsing items"), STAT_ItemPulseItems, STATGROUP_ItemPulse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pulse curve evaluations"), STAT_ItemPulseEvaluations, STATGROUP_ItemPulse);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Material updates saved"), STAT_ItemPulseUpdatesSaved, STATGROUP_ItemPulse);
+
+bool FItemPulseGroupKey::operator==(const FItemPulseGroupKey& Other) const
+{
+	return PulseCurve == Other.PulseCurve &&
+		MaterialInstance == Other.MaterialInstance &&
+		GlowColor == Other.GlowColor &&
+		PulseCurveTime == Other.PulseCurveTime &&
+		ParameterScale == Other.ParameterScale;
+}
+
+void UItemPulseSubsystem::Deinitialize()
+{
+	Groups.Empty();
+	ItemGroups.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UItemPulseSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemPulseSubsystem, STATGROUP_ItemPulse);
+}
+
+void UItemPulseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_ItemPulseUpdate);
+
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	for (FItemPulseGroup& Group : Groups)
+	{
+		// the curve may still be destroyed explicitly, e.g. by a reimport in the editor
+		if (Group.Key.PulseCurve == nullptr || Group.SharedMaterial == nullptr) continue;
+
+		// one curve evaluation and one set of parameter writes for the whole group
+		const float ElapsedTime = FMath::Fmod(WorldTime, Group.Key.PulseCurveTime);
+		const FVector CurveValue = Group.Key.PulseCurve->GetVectorValue(ElapsedTime) * Group.Key.ParameterScale;
+
+		Group.SharedMaterial->SetScalarParameterValue(TEXT("GlowAmount"), CurveValue.X);
+		Group.SharedMaterial->SetScalarParameterValue(TEXT("FresnelExponent"), CurveValue.Y);
+		Group.SharedMaterial->SetScalarParameterValue(TEXT("FresnelReflectFraction"), CurveValue.Z);
+
+		INC_DWORD_STAT(STAT_ItemPulseEvaluations);
+		INC_DWORD_STAT_BY(STAT_ItemPulseItems, Group.Items.Num());
+		INC_DWORD_STAT_BY(STAT_ItemPulseUpdatesSaved, Group.Items.Num() - 1);
+	}
+}
+
+void UItemPulseSubsystem::RegisterItem(AItem* Item)
+{
+	if (Item == nullptr || Item->GetPulseCurve() == nullptr || Item->GetMaterialInstance() == nullptr) return;
+	if (Item->GetPulseCurveTime() <= 0.f) return;
+	if (ItemGroups.Contains(Item)) return;
+
+	const int32 GroupIndex = FindOrAddGroup(Item);
+	Groups[GroupIndex].Items.Add(Item);
+	ItemGroups.Add(Item, GroupIndex);
+
+	Item->GetItemMesh()->SetMaterial(Item->GetMaterialIndex(), Groups[GroupIndex].SharedMaterial);
+}
+
+void UItemPulseSubsystem::UnregisterItem(AItem* Item)
+{
+	int32 GroupIndex{INDEX_NONE};
+	if (!ItemGroups.RemoveAndCopyValue(Item, GroupIndex)) return;
+
+	Groups[GroupIndex].Items.RemoveSwap(Item);
+	if (Groups[GroupIndex].Items.Num() == 0)
+	{
+		RemoveGroup(GroupIndex);
+	}
+
+	// back to the item's own material so it can glow and pulse on its own again
+	if (Item->GetDynamicMaterialInstance())
+	{
+		Item->GetItemMesh()->SetMaterial(Item->GetMaterialIndex(), Item->GetDynamicMaterialInstance());
+	}
+}
+
+FItemPulseGroupKey UItemPulseSubsystem::MakeGroupKey(const AItem* Item)
+{
+	FItemPulseGroupKey Key;
+	Key.PulseCurve = Item->GetPulseCurve();
+	Key.MaterialInstance = Item->GetMaterialInstance();
+	Key.GlowColor = Item->GetGlowColor();
+	Key.PulseCurveTime = Item->GetPulseCurveTime();
+	Key.ParameterScale = FVector(Item->GetGlowAmount(), Item->GetFresnelExponent(), Item->GetFresnelReflectFraction());
+	return Key;
+}
+
+int32 UItemPulseSubsystem::FindOrAddGroup(const AItem* Item)
+{
+	const FItemPulseGroupKey Key = MakeGroupKey(Item);
+	const int32 ExistingIndex = Groups.IndexOfByPredicate([&Key](const FItemPulseGroup& Group)
+	{
+		return Group.Key == Key;
+	});
+	if (ExistingIndex != INDEX_NONE)
+	{
+		return ExistingIndex;
+	}
+
+	// same setup as AItem::OnConstruction, with the glow enabled
+	UMaterialInstanceDynamic* SharedMaterial = UMaterialInstanceDynamic::Create(Key.MaterialInstance, this);
+	SharedMaterial->SetVectorParameterValue(TEXT("FresnelColor"), Key.GlowColor);
+	SharedMaterial->SetScalarParameterValue(TEXT("GlowBlendAlpha"), 0);
+
+	FItemPulseGroup Group;
+	Group.Key = Key;
+	Group.SharedMaterial = SharedMaterial;
+	return Groups.Add(MoveTemp(Group));
+}
+
+void UItemPulseSubsystem::RemoveGroup(int32 GroupIndex)
+{
+	const int32 LastIndex = Groups.Num() - 1;
+	if (GroupIndex != LastIndex)
+	{
+		for (const TWeakObjectPtr<AItem>& MovedItem : Groups[LastIndex].Items)
+		{
+			ItemGroups.FindChecked(MovedItem) = GroupIndex;
+		}
+	}
+	Groups.RemoveAtSwap(GroupIndex);
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemPulseSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("ItemPulse"), STATGROUP_ItemPulse, STATCAT_Advanced);
+
+// everything that has to match for two items to pulse in the same phase
+USTRUCT()
+struct FItemPulseGroupKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<class UCurveVector> PulseCurve;
+
+	UPROPERTY()
+	TObjectPtr<class UMaterialInstance> MaterialInstance;
+
+	FLinearColor GlowColor{ForceInit};
+	float PulseCurveTime{0.f};
+	FVector ParameterScale{ForceInit};
+
+	bool operator==(const FItemPulseGroupKey& Other) const;
+};
+
+// items pulsing in the same phase. the UPROPERTYs keep the curve and materials alive while the group exists
+USTRUCT()
+struct FItemPulseGroup
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FItemPulseGroupKey Key;
+
+	// material shown by every item of the group while it pulses
+	UPROPERTY()
+	TObjectPtr<class UMaterialInstanceDynamic> SharedMaterial;
+
+	UPROPERTY()
+	TArray<TWeakObjectPtr<class AItem>> Items;
+};
+
+/**
+ * Drives the glow pulse of every item lying in the world in the Pickup state.
+ * Items with the same material, glow color, pulse curve and pulse parameters are in the same pulse phase.
+ * They share one dynamic material instance, so the curve is evaluated and the material parameters are written
+ * once per phase group per frame instead of once per item.
+ */
+UCLASS()
+class THIRDPERSONESHOOTER_API UItemPulseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// starts pulsing the item. swaps its glow material for the shared material of its phase group
+	void RegisterItem(class AItem* Item);
+
+	// stops pulsing the item and gives it back its own dynamic material instance
+	void UnregisterItem(class AItem* Item);
+
+private:
+	static FItemPulseGroupKey MakeGroupKey(const AItem* Item);
+
+	int32 FindOrAddGroup(const AItem* Item);
+
+	// removes the group once its last item is unregistered, moving the last group into its slot
+	void RemoveGroup(int32 GroupIndex);
+
+	UPROPERTY()
+	TArray<FItemPulseGroup> Groups;
+
+	// group index of every registered item
+	TMap<TWeakObjectPtr<AItem>, int32> ItemGroups;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemStateProfile.h"
+
+#include "Components/PrimitiveComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Component updates"), STAT_ItemComponentUpdates, STATGROUP_ItemState);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Component updates skipped"), STAT_ItemComponentUpdatesSkipped, STATGROUP_ItemState);
+
+namespace
+{
+	FCollisionResponseContainer MakeResponses(
+		ECollisionResponse DefaultResponse,
+		ECollisionChannel Channel = ECollisionChannel::ECC_MAX,
+		ECollisionResponse ChannelResponse = ECollisionResponse::ECR_Ignore)
+	{
+		FCollisionResponseContainer Responses{DefaultResponse};
+		if (Channel != ECollisionChannel::ECC_MAX)
+		{
+			Responses.SetResponse(Channel, ChannelResponse);
+		}
+		return Responses;
+	}
+
+	TArray<FItemStateProfile> MakeProfiles()
+	{
+		const FCollisionResponseContainer IgnoreAll{MakeResponses(ECollisionResponse::ECR_Ignore)};
+
+		// no collision, no physics
+		const FItemComponentProfile Disabled{false, false, true, ECollisionEnabled::NoCollision, IgnoreAll};
+		const FItemComponentProfile Hidden{false, false, false, ECollisionEnabled::NoCollision, IgnoreAll};
+
+		// lying in the world, waiting to be picked up
+		FItemStateProfile Pickup;
+		Pickup.Mesh = Disabled;
+		Pickup.AreaSphere = {
+			false, false, true, ECollisionEnabled::QueryOnly, MakeResponses(ECollisionResponse::ECR_Overlap)
+		};
+		Pickup.CollisionBox = {
+			false, false, true, ECollisionEnabled::QueryAndPhysics,
+			MakeResponses(ECollisionResponse::ECR_Ignore, ECollisionChannel::ECC_Visibility,
+			              ECollisionResponse::ECR_Block)
+		};
+		Pickup.bHidePickupWidget = false;
+
+		// interping to the character or held by it
+		FItemStateProfile Held;
+		Held.Mesh = Disabled;
+		Held.AreaSphere = Disabled;
+		Held.CollisionBox = Disabled;
+		Held.bHidePickupWidget = true;
+
+		// in the inventory
+		FItemStateProfile PickedUp{Held};
+		PickedUp.Mesh = Hidden;
+
+		// thrown by the character, blocks the world only
+		FItemStateProfile Falling;
+		Falling.Mesh = {
+			true, true, true, ECollisionEnabled::QueryAndPhysics,
+			MakeResponses(ECollisionResponse::ECR_Ignore, ECollisionChannel::ECC_WorldStatic,
+			              ECollisionResponse::ECR_Block)
+		};
+		Falling.AreaSphere = Disabled;
+		Falling.CollisionBox = Disabled;
+		Falling.bHidePickupWidget = false;
+
+		// in EItemState order
+		return {Pickup, Held, PickedUp, Held, Falling};
+	}
+}
+
+const FItemStateProfile* FItemStateProfiles::Get(EItemState State)
+{
+	static const TArray<FItemStateProfile> Profiles{MakeProfiles()};
+	static_assert(static_cast<int32>(EItemState::EIS_Max) == 5, "Update MakeProfiles for the new item state");
+
+	const int32 Index = static_cast<int32>(State);
+	return Profiles.IsValidIndex(Index) ? &Profiles[Index] : nullptr;
+}
+
+void FItemStateProfiles::Apply(UPrimitiveComponent* Component, const FItemComponentProfile& Profile)
+{
+	if (Component == nullptr) return;
+
+	const bool bPhysicsChanged = Component->IsSimulatingPhysics() != Profile.bSimulatePhysics;
+	const bool bGravityChanged = Component->IsGravityEnabled() != Profile.bEnableGravity;
+	const bool bVisibilityChanged = Component->IsVisible() != Profile.bVisible;
+	const bool bCollisionChanged = Component->GetCollisionEnabled() != Profile.CollisionEnabled;
+	const bool bResponsesChanged = !(Component->GetCollisionResponseToChannels() == Profile.Responses);
+
+	if (!(bPhysicsChanged || bGravityChanged || bVisibilityChanged || bCollisionChanged || bResponsesChanged))
+	{
+		INC_DWORD_STAT(STAT_ItemComponentUpdatesSkipped);
+		return;
+	}
+	INC_DWORD_STAT(STAT_ItemComponentUpdates);
+
+	// stop simulating before collision goes away
+	if (bPhysicsChanged && !Profile.bSimulatePhysics)
+	{
+		Component->SetSimulatePhysics(false);
+	}
+	if (bGravityChanged)
+	{
+		Component->SetEnableGravity(Profile.bEnableGravity);
+	}
+	if (bVisibilityChanged)
+	{
+		Component->SetVisibility(Profile.bVisible);
+	}
+	if (bResponsesChanged)
+	{
+		Component->SetCollisionResponseToChannels(Profile.Responses);
+	}
+	if (bCollisionChanged)
+	{
+		Component->SetCollisionEnabled(Profile.CollisionEnabled);
+	}
+	// start simulating once the collision is there
+	if (bPhysicsChanged && Profile.bSimulatePhysics)
+	{
+		Component->SetSimulatePhysics(true);
+	}
+}
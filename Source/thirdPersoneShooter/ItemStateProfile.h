@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Item.h"
+
+DECLARE_STATS_GROUP(TEXT("ItemState"), STATGROUP_ItemState, STATCAT_Advanced);
+
+// physics, visibility and collision setup of one item component in one item state
+struct FItemComponentProfile
+{
+	bool bSimulatePhysics;
+	bool bEnableGravity;
+	bool bVisible;
+	ECollisionEnabled::Type CollisionEnabled;
+	FCollisionResponseContainer Responses;
+};
+
+// setup of every item component in one item state
+struct FItemStateProfile
+{
+	// the item mesh, also used for the ammo mesh
+	FItemComponentProfile Mesh;
+	FItemComponentProfile AreaSphere;
+	FItemComponentProfile CollisionBox;
+
+	bool bHidePickupWidget;
+};
+
+/**
+ * Precomputed table of FItemStateProfile, one per EItemState.
+ * Applying a profile makes one call per property that actually changes, so components that are already in
+ * the target state cost only the comparisons.
+ */
+struct FItemStateProfiles
+{
+	// nullptr for states which leave the components untouched
+	static const FItemStateProfile* Get(EItemState State);
+
+	static void Apply(UPrimitiveComponent* Component, const FItemComponentProfile& Profile);
+};
@@ -4,6 +4,8 @@
 #include "ShooterCharacter.h"
 
 #include "Ammo.h"
+#include "CrosshairTraceSubsystem.h"
+#include "EffectPoolSubsystem.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Camera/CameraComponent.h"
@@ -393,18 +395,16 @@ void AShooterCharacter::SendBullet() const
 {
 	// show fire flashes on the barrel
 	const USkeletalMeshSocket* BarrelSocket = EquippedWeapon->GetItemMesh()->GetSocketByName("BarrelSocket");
-	if (BarrelSocket)
+	UEffectPoolSubsystem* EffectPool = GetWorld()->GetSubsystem<UEffectPoolSubsystem>();
+	if (BarrelSocket && EffectPool)
 	{
 		// position of the muzzle barrel of the gun
 		const FTransform socketTransform = BarrelSocket->GetSocketTransform(EquippedWeapon->GetItemMesh());
 
+		// every shot spawns its effects from the pool
 		if (EquippedWeapon->GetMuzzleFlash())
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(
-				GetWorld(),
-				EquippedWeapon->GetMuzzleFlash(),
-				socketTransform
-			);
+			EffectPool->SpawnEmitterAtLocation(EquippedWeapon->GetMuzzleFlash(), socketTransform);
 		}
 
 		FVector BeamEndPoint;
@@ -414,13 +414,12 @@ void AShooterCharacter::SendBullet() const
 			// spawn impact particles after updating BeamEndpoint
 			if (ImpactParticles)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamEndPoint);
+				EffectPool->SpawnEmitterAtLocation(ImpactParticles, FTransform(BeamEndPoint));
 			}
 
 			if (BeamParticles)
 			{
-				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-					GetWorld(), BeamParticles, socketTransform);
+				UParticleSystemComponent* Beam = EffectPool->SpawnEmitterAtLocation(BeamParticles, socketTransform);
 
 				if (Beam)
 				{
@@ -799,42 +798,16 @@ bool AShooterCharacter::TraceUnderCrosshair(
 	FHitResult& OutHitResult,
 	FVector& OutHitLocation) const
 {
-	// Get Viewport Size
-	FVector2D ViewportSize;
-	if (GEngine && GEngine->GameViewport)
-	{
-		GEngine->GameViewport->GetViewportSize(ViewportSize);
-	}
-
-	// Get screen space location of crosshairs
-	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-	CrosshairLocation.Y -= 50.f;
-	FVector CrosshairWorldPosition;
-	FVector CrosshairWorldDirection;
+	// the crosshair trace is shared with everyone else asking for it this frame
+	UCrosshairTraceSubsystem* CrosshairTraceSubsystem = GetWorld()->GetSubsystem<UCrosshairTraceSubsystem>();
+	if (CrosshairTraceSubsystem == nullptr) return false;
 
-	// Get world position and direction of crosshairs
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
-		UGameplayStatics::GetPlayerController(this, 0),
-		CrosshairLocation,
-		CrosshairWorldPosition,
-		CrosshairWorldDirection);
-
-	if (bScreenToWorld)
+	FCrosshairTrace CrosshairTrace;
+	if (CrosshairTraceSubsystem->GetCrosshairTrace(Cast<APlayerController>(GetController()), CrosshairTrace))
 	{
-		// Trace from Crosshair world location outward
-		const FVector Start{CrosshairWorldPosition};
-		const FVector End{Start + CrosshairWorldDirection * AShooterCharacter::MAX_TRACE_DISTANCE_FOR_SHOOTING};
-		OutHitLocation = End;
-		GetWorld()->LineTraceSingleByChannel(
-			OutHitResult,
-			Start,
-			End,
-			ECollisionChannel::ECC_Visibility);
-		if (OutHitResult.bBlockingHit)
-		{
-			OutHitLocation = OutHitResult.Location;
-			return true;
-		}
+		OutHitResult = CrosshairTrace.HitResult;
+		OutHitLocation = CrosshairTrace.HitLocation;
+		return CrosshairTrace.bBlockingHit;
 	}
 	return false;
 }
@@ -44,7 +44,6 @@ public:
 	// Sets default values for this character's properties
 	AShooterCharacter();
 
-	inline static const float MAX_TRACE_DISTANCE_FOR_SHOOTING{50000.f};
 	inline static const float MAX_TRACE_DISTANCE_FOR_ITEMS {20000.f};
 
 protected:
@@ -86,7 +85,7 @@ protected:
 	UFUNCTION()
 	void AutoFireReset();
 
-	// line trace for items under the crosshair
+	// line trace under the crosshair, shared per frame through UCrosshairTraceSubsystem
 	bool TraceUnderCrosshair(FHitResult& OutHitResult, FVector& OutHitLocation) const;
 
 	// Trace for items in visibity is overlapped item count > 0
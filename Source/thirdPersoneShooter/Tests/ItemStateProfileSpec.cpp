@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemStateProfile.h"
+
+#include "Components/BoxComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FItemStateProfileSpec, "thirdPersoneShooter.Item.StateProfile",
+                  EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+	UBoxComponent* Component;
+
+	// true when the component matches every property the profile sets, physics aside
+	bool Matches(const FItemComponentProfile& Profile) const
+	{
+		return Component->IsVisible() == Profile.bVisible &&
+			Component->IsGravityEnabled() == Profile.bEnableGravity &&
+			Component->GetCollisionEnabled() == Profile.CollisionEnabled &&
+			Component->GetCollisionResponseToChannels() == Profile.Responses;
+	}
+
+END_DEFINE_SPEC(FItemStateProfileSpec)
+
+void FItemStateProfileSpec::Define()
+{
+	Describe("Get", [this]()
+	{
+		It("has a profile for every item state", [this]()
+		{
+			for (int32 i = 0; i < static_cast<int32>(EItemState::EIS_Max); i++)
+			{
+				TestNotNull(FString::Printf(TEXT("profile of state %d"), i),
+				            FItemStateProfiles::Get(static_cast<EItemState>(i)));
+			}
+		});
+
+		It("has no profile past the last state", [this]()
+		{
+			TestNull(TEXT("profile of EIS_Max"), FItemStateProfiles::Get(EItemState::EIS_Max));
+		});
+
+		It("lets only the collision box of a pickup block visibility traces", [this]()
+		{
+			const FItemStateProfile* Pickup = FItemStateProfiles::Get(EItemState::EIS_Pickup);
+			TestTrue(TEXT("collision box"),
+			         Pickup->CollisionBox.Responses.GetResponse(ECC_Visibility) == ECollisionResponse::ECR_Block);
+			TestTrue(TEXT("area sphere"),
+			         Pickup->AreaSphere.Responses.GetResponse(ECC_Visibility) == ECollisionResponse::ECR_Overlap);
+			TestTrue(TEXT("mesh"), Pickup->Mesh.CollisionEnabled == ECollisionEnabled::NoCollision);
+			TestFalse(TEXT("pickup widget hidden"), Pickup->bHidePickupWidget);
+		});
+
+		It("hides the mesh of an item in the inventory only", [this]()
+		{
+			TestFalse(TEXT("picked up"), FItemStateProfiles::Get(EItemState::EIS_PickedUp)->Mesh.bVisible);
+			TestTrue(TEXT("equipped"), FItemStateProfiles::Get(EItemState::EIS_Equipped)->Mesh.bVisible);
+		});
+
+		It("simulates the mesh of a falling item", [this]()
+		{
+			const FItemStateProfile* Falling = FItemStateProfiles::Get(EItemState::EIS_Falling);
+			TestTrue(TEXT("physics"), Falling->Mesh.bSimulatePhysics);
+			TestTrue(TEXT("world static"),
+			         Falling->Mesh.Responses.GetResponse(ECC_WorldStatic) == ECollisionResponse::ECR_Block);
+		});
+	});
+
+	Describe("Apply", [this]()
+	{
+		BeforeEach([this]()
+		{
+			Component = NewObject<UBoxComponent>(GetTransientPackage());
+		});
+
+		AfterEach([this]()
+		{
+			Component->MarkAsGarbage();
+			Component = nullptr;
+		});
+
+		It("moves a component to the profile", [this]()
+		{
+			const FItemComponentProfile& Profile = FItemStateProfiles::Get(EItemState::EIS_Pickup)->CollisionBox;
+			FItemStateProfiles::Apply(Component, Profile);
+			TestTrue(TEXT("matches the pickup collision box"), Matches(Profile));
+		});
+
+		It("moves a component between profiles", [this]()
+		{
+			const FItemComponentProfile& Pickup = FItemStateProfiles::Get(EItemState::EIS_Pickup)->AreaSphere;
+			const FItemComponentProfile& PickedUp = FItemStateProfiles::Get(EItemState::EIS_PickedUp)->Mesh;
+			FItemStateProfiles::Apply(Component, Pickup);
+			FItemStateProfiles::Apply(Component, PickedUp);
+			TestTrue(TEXT("matches the picked up mesh"), Matches(PickedUp));
+		});
+
+		It("leaves a component already in the profile as it is", [this]()
+		{
+			const FItemComponentProfile& Profile = FItemStateProfiles::Get(EItemState::EIS_Pickup)->AreaSphere;
+			FItemStateProfiles::Apply(Component, Profile);
+			FItemStateProfiles::Apply(Component, Profile);
+			TestTrue(TEXT("matches the pickup area sphere"), Matches(Profile));
+		});
+
+		It("ignores a null component", [this]()
+		{
+			FItemStateProfiles::Apply(nullptr, FItemStateProfiles::Get(EItemState::EIS_Pickup)->Mesh);
+		});
+	});
+}
+
+#endif
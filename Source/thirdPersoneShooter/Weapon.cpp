@@ -3,6 +3,8 @@
 
 #include "Weapon.h"
 
+#include "ItemDataSubsystem.h"
+
 // #include "Particles/ParticleSystem.h"
 // #include "Sound/SoundCue.h"
 
@@ -25,6 +27,7 @@ AWeapon::AWeapon():
 
 {
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 }
 
 void AWeapon::BeginPlay()
@@ -76,37 +79,19 @@ void AWeapon::StopFalling()
 {
 	bFalling = false;
 	SetItemState(EItemState::EIS_Pickup);
-	StartPulseTimer();
+
+	StartPulse();
 }
 
 void AWeapon::OnConstruction(const FTransform& WeaponTransform)
 {
 	Super::OnConstruction(WeaponTransform);
-	const FString WeaponTablePath{TEXT("DataTable'/Game/_Game/DataTables/WeaponDataTable.WeaponDataTable'")};
-
-	UDataTable* WeaponTableObject = Cast<UDataTable>(
-		StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
 
-	if (WeaponTableObject)
+	// row of the weapon datatable, cached by UItemDataSubsystem
+	UItemDataSubsystem* ItemDataSubsystem = UItemDataSubsystem::Get();
+	if (ItemDataSubsystem)
 	{
-		FWeaponDataTable* WeaponDataRow{nullptr};
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_SMG:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("SubMachineGun"), TEXT(""));
-			break;
-
-		case EWeaponType::EWT_AR:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
-
-		case EWeaponType::EWT_PISTOL:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Pistol"), TEXT(""));
-			break;
-
-		default:
-			break;
-		}
+		const FWeaponDataTable* WeaponDataRow = ItemDataSubsystem->GetWeaponRow(WeaponType);
 
 		if (WeaponDataRow)
 		{
@@ -192,11 +177,18 @@ void AWeapon::StartSlideTimer()
 		&AWeapon::FinishMovingSlide,
 		SlideDisplacementTime);
 	bMovingSlide = true;
+	UpdateTickEnabled();
 }
 
 void AWeapon::FinishMovingSlide()
 {
 	bMovingSlide = false;
+	UpdateTickEnabled();
+}
+
+bool AWeapon::ShouldTick() const
+{
+	return bMovingSlide || Super::ShouldTick();
 }
 
 void AWeapon::UpdateSlideDisplacement(float DeltaTime)
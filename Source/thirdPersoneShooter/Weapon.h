@@ -111,6 +111,9 @@ protected:
 	void FinishMovingSlide();
 	void UpdateSlideDisplacement(float DeltaTime);
 
+	// weapons also tick while the pistol slide is moving
+	virtual bool ShouldTick() const override;
+
 private:
 	FTimerHandle ThrowWeaponTimer;
 	float ThrowWeaponTime;